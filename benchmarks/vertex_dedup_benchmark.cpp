@@ -0,0 +1,151 @@
+// Compares vertex welding through LveDedupTable against the std::unordered_map path that
+// LveModel::Builder used before.
+//
+//   VertexDedupBenchmark [model.obj]
+//
+// Without an argument a synthetic grid with a few million corners is used.
+
+#include "lve/lve_dedup_table.hpp"
+#include "lve/lve_model.hpp"
+#include "lve/lve_obj_parser.hpp"
+#include "lve/lve_utils.hpp"
+
+// libs
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+using lve::LveModel;
+
+namespace std {
+template <>
+struct hash<LveModel::Vertex> {
+  size_t operator()(LveModel::Vertex const &vertex) const {
+    size_t seed = 0;
+    lve::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
+    return seed;
+  }
+};
+}  // namespace std
+
+namespace {
+
+constexpr int kRuns = 5;
+
+// every interior grid vertex is shared by six triangles, close to what scanned meshes look like
+std::vector<LveModel::Vertex> makeGridCorners(uint32_t size) {
+  std::vector<LveModel::Vertex> corners;
+  corners.reserve(static_cast<size_t>(size) * size * 6);
+  auto vertexAt = [size](uint32_t x, uint32_t y) {
+    LveModel::Vertex vertex{};
+    vertex.position = {static_cast<float>(x), 0.f, static_cast<float>(y)};
+    vertex.color = {1.f, 1.f, 1.f};
+    vertex.normal = {0.f, -1.f, 0.f};
+    vertex.uv = {x / static_cast<float>(size), y / static_cast<float>(size)};
+    return vertex;
+  };
+  for (uint32_t y = 0; y < size; y++) {
+    for (uint32_t x = 0; x < size; x++) {
+      corners.push_back(vertexAt(x, y));
+      corners.push_back(vertexAt(x + 1, y));
+      corners.push_back(vertexAt(x + 1, y + 1));
+      corners.push_back(vertexAt(x, y));
+      corners.push_back(vertexAt(x + 1, y + 1));
+      corners.push_back(vertexAt(x, y + 1));
+    }
+  }
+  return corners;
+}
+
+std::vector<LveModel::Vertex> loadCorners(const std::string &filepath) {
+  lve::LveObjData obj = lve::parseObj(filepath);
+  std::vector<LveModel::Vertex> corners;
+  corners.reserve(obj.corners.size());
+  for (const auto &corner : obj.corners) {
+    LveModel::Vertex vertex{};
+    vertex.position = obj.positions[corner.position];
+    vertex.color = obj.colors[corner.position];
+    if (corner.normal >= 0) vertex.normal = obj.normals[corner.normal];
+    if (corner.texCoord >= 0) vertex.uv = obj.texCoords[corner.texCoord];
+    corners.push_back(vertex);
+  }
+  return corners;
+}
+
+void weldUnorderedMap(
+    const std::vector<LveModel::Vertex> &corners,
+    std::vector<LveModel::Vertex> &vertices,
+    std::vector<uint32_t> &indices) {
+  std::unordered_map<LveModel::Vertex, uint32_t> uniqueVertices{};
+  for (const auto &vertex : corners) {
+    if (uniqueVertices.count(vertex) == 0) {
+      uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+      vertices.push_back(vertex);
+    }
+    indices.push_back(uniqueVertices[vertex]);
+  }
+}
+
+void weldDedupTable(
+    const std::vector<LveModel::Vertex> &corners,
+    std::vector<LveModel::Vertex> &vertices,
+    std::vector<uint32_t> &indices) {
+  lve::LveDedupTable<LveModel::Vertex> uniqueVertices{vertices, corners.size()};
+  for (const auto &vertex : corners) {
+    indices.push_back(uniqueVertices.insert(vertex));
+  }
+}
+
+template <typename Weld>
+double bestOf(
+    Weld weld,
+    const std::vector<LveModel::Vertex> &corners,
+    std::vector<LveModel::Vertex> &vertices,
+    std::vector<uint32_t> &indices) {
+  double best = 1e30;
+  for (int run = 0; run < kRuns; run++) {
+    vertices.clear();
+    indices.clear();
+    indices.reserve(corners.size());
+    auto start = std::chrono::steady_clock::now();
+    weld(corners, vertices, indices);
+    auto end = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  return best;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  try {
+    std::vector<LveModel::Vertex> corners = argc > 1 ? loadCorners(argv[1]) : makeGridCorners(768);
+
+    std::vector<LveModel::Vertex> mapVertices, tableVertices;
+    std::vector<uint32_t> mapIndices, tableIndices;
+    double mapTime = bestOf(weldUnorderedMap, corners, mapVertices, mapIndices);
+    double tableTime = bestOf(weldDedupTable, corners, tableVertices, tableIndices);
+
+    std::cout << "corners: " << corners.size() << ", unique vertices: " << tableVertices.size()
+              << " (unordered_map: " << mapVertices.size() << ")" << std::endl;
+    std::cout << "unordered_map: " << mapTime << " ms" << std::endl;
+    std::cout << "LveDedupTable: " << tableTime << " ms (" << mapTime / tableTime << "x)"
+              << std::endl;
+
+    if (mapIndices != tableIndices) {
+      // only expected when the mesh mixes 0.0 and -0.0 in otherwise identical vertices
+      std::cout << "warning: index buffers differ" << std::endl;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -1,6 +1,2 @@
-# Optional set TINYOBJ_PATH to target specific version, otherwise defaults to external/tinyobjloader
-# set(TINYOBJ_PATH /Users/brendan/dev/tinyobjloader)
-
 set(GLFW_PATH "${CMAKE_SOURCE_DIR}/lib/glfw-3.4.bin.WIN64")
-set(GLM_PATH "${CMAKE_SOURCE_DIR}/lib/glm-1.0.2")
-set(TINYOBJ_PATH "${CMAKE_SOURCE_DIR}/lib/tinyobjloader-release")
\ No newline at end of file
+set(GLM_PATH "${CMAKE_SOURCE_DIR}/lib/glm-1.0.2")
\ No newline at end of file
@@ -0,0 +1,31 @@
+#version 450
+
+// positions only, for every LveModel::VertexFormat: fp32 positions get w = 1 from the vertex
+// input, unorm16 ones are dequantized by the model matrix just like in the main pass
+layout(location = 0) in vec4 position;
+
+struct PointLight {
+  vec4 position; // ignore w
+  vec4 color; // w is intensity
+};
+
+layout(set = 0, binding = 0) uniform GlobalUbo {
+  mat4 projection;
+  mat4 view;
+  mat4 invView;
+  vec4 ambientLightColor; // w is intensity
+  PointLight pointLights[10];
+  int numLights;
+} ubo;
+
+layout(push_constant) uniform Push {
+  mat4 modelMatrix;
+} push;
+
+// must match the main pass bit for bit, it depth tests with EQUAL against this
+invariant gl_Position;
+
+void main() {
+  vec4 positionWorld = push.modelMatrix * vec4(position.xyz, 1.0);
+  gl_Position = ubo.projection * ubo.view * positionWorld;
+}
@@ -29,6 +29,9 @@ layout(push_constant) uniform Push {
   mat4 normalMatrix;
 } push;
 
+// the depth pre-pass computes the same position, EQUAL depth testing relies on it
+invariant gl_Position;
+
 void main() {
   vec4 positionWorld = push.modelMatrix * vec4(position, 1.0);
   gl_Position = ubo.projection * ubo.view * positionWorld;
@@ -0,0 +1,51 @@
+#version 450
+
+// vertex shader for LveModel::VertexFormat::Compact / CompactWrappedUv, the vertex input unpacks
+// unorm16 positions, snorm16 octahedral normals and unorm16 or half uvs to floats for us
+layout(location = 0) in vec4 position; // [0, 1] inside the mesh bounds, w unused
+layout(location = 2) in vec2 normal;
+layout(location = 3) in vec2 uv;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragPosWorld;
+layout(location = 2) out vec3 fragNormalWorld;
+layout(location = 3) out vec2 fragUV;
+
+struct PointLight {
+  vec4 position; // ignore w
+  vec4 color; // w is intensity
+};
+
+layout(set = 0, binding = 0) uniform GlobalUbo {
+  mat4 projection;
+  mat4 view;
+  mat4 invView;
+  vec4 ambientLightColor; // w is intensity
+  PointLight pointLights[10];
+  int numLights;
+} ubo;
+
+layout(push_constant) uniform Push {
+  mat4 modelMatrix; // includes the dequantization from the mesh bounds
+  mat4 normalMatrix;
+} push;
+
+vec3 octDecode(vec2 e) {
+  vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+  float t = max(-n.z, 0.0);
+  n.x += n.x >= 0.0 ? -t : t;
+  n.y += n.y >= 0.0 ? -t : t;
+  return normalize(n);
+}
+
+// the depth pre-pass computes the same position, EQUAL depth testing relies on it
+invariant gl_Position;
+
+void main() {
+  vec4 positionWorld = push.modelMatrix * vec4(position.xyz, 1.0);
+  gl_Position = ubo.projection * ubo.view * positionWorld;
+  fragNormalWorld = normalize(mat3(push.normalMatrix) * octDecode(normal));
+  fragPosWorld = positionWorld.xyz;
+  fragColor = vec3(1.0);
+  fragUV = uv;
+}
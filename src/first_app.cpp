@@ -3,6 +3,7 @@
 #include "lve/lve_buffer.hpp"
 #include "lve/lve_camera.hpp"
 #include "movement_controller.hpp"
+#include "systems/depth_prepass_system.hpp"
 #include "systems/point_light_system.hpp"
 #include "systems/simple_render_system.hpp"
 #include "lve/lve_texture.hpp"
@@ -19,6 +20,7 @@
 #include <array>
 #include <cassert>
 #include <chrono>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
 
@@ -55,20 +57,10 @@ void FirstApp::run() {
           .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, LveSwapChain::MAX_FRAMES_IN_FLIGHT)
           .build();
 
-  // Frame descriptor pool for per-object textures
-  std::vector<std::unique_ptr<LveDescriptorPool>> framePools(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-  for (int i = 0; i < framePools.size(); i++) {
-    framePools[i] = LveDescriptorPool::Builder(lveDevice)
-                        .setMaxSets(1000)  // Enough for many objects
-                        .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1000)
-                        .setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT)
-                        .build();
-  }
-
   auto globalSetLayout =
       LveDescriptorSetLayout::Builder(lveDevice)
           .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
-          .build();
+          .buildCached();
 
   std::vector<VkDescriptorSet> globalDescriptorSets(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
   for (int i = 0; i < globalDescriptorSets.size(); i++) {
@@ -82,6 +74,12 @@ void FirstApp::run() {
       lveDevice,
       lveRenderer.getSwapChainRenderPass(),
       globalSetLayout->getDescriptorSetLayout()};
+  // depth first from the position streams, so the lighting in the main pass runs once per pixel
+  DepthPrepassSystem depthPrepassSystem{
+      lveDevice,
+      lveRenderer.getSwapChainRenderPass(),
+      globalSetLayout->getDescriptorSetLayout()};
+  simpleRenderSystem.setDepthPrepass(true);
   PointLightSystem pointLightSystem{
       lveDevice,
       lveRenderer.getSwapChainRenderPass(),
@@ -97,6 +95,8 @@ void FirstApp::run() {
   bool keyPressed[7] = {false, false, false, false, false,false,false};
   while (!lveWindow.shouldClose()) {
     glfwPollEvents();
+    // swap in whatever finished loading since the last frame
+    assetLoader.pump();
 
     auto newTime = std::chrono::high_resolution_clock::now();
     float frameTime =
@@ -135,6 +135,16 @@ void FirstApp::run() {
       }
     }
 
+    // M - dump device memory statistics
+    if (glfwGetKey(lveWindow.getGLFWwindow(), GLFW_KEY_M) == GLFW_PRESS) {
+      if (!keyPressed[6]) {
+        keyPressed[6] = true;
+        dumpMemoryStats("memory_stats.json");
+      }
+    } else {
+      keyPressed[6] = false;
+    }
+
     cameraController.moveInPlaneXZ(lveWindow.getGLFWwindow(), frameTime, viewerObject);
     camera.setViewYXZ(viewerObject.transform.translation, viewerObject.transform.rotation);
 
@@ -143,7 +153,12 @@ void FirstApp::run() {
 
     if (auto commandBuffer = lveRenderer.beginFrame()) {
       int frameIndex = lveRenderer.getFrameIndex();
-      framePools[frameIndex]->resetPool();
+      assetRegistry.beginFrame(frameIndex);
+      // compacts a bit of geometry and texture memory once streaming is idle and enough block
+      // space is wasted, the copies run at the start of this frame
+      if (assetRegistry.shouldDefragment(32 * 1024 * 1024)) {
+        assetRegistry.defragment(commandBuffer, 8 * 1024 * 1024);
+      }
 
       FrameInfo frameInfo{
           frameIndex,
@@ -151,8 +166,8 @@ void FirstApp::run() {
           commandBuffer,
           camera,
           globalDescriptorSets[frameIndex],
-          *framePools[frameIndex],
-          gameObjects};
+          gameObjects,
+          lveRenderer.getSwapChainExtent()};
 
       // update
       GlobalUbo ubo{};
@@ -164,9 +179,11 @@ void FirstApp::run() {
       uboBuffers[frameIndex]->flush();
 
       // render
+      simpleRenderSystem.selectLods(frameInfo);
       lveRenderer.beginSwapChainRenderPass(commandBuffer);
 
       // order here matters
+      depthPrepassSystem.render(frameInfo, simpleRenderSystem.getDrawEntries());
       simpleRenderSystem.renderGameObjects(frameInfo);
       pointLightSystem.render(frameInfo);
 
@@ -177,29 +194,63 @@ void FirstApp::run() {
   vkDeviceWaitIdle(lveDevice.device());
 }
 
+void FirstApp::dumpMemoryStats(const std::string &path) {
+  LveMemoryStats stats = lveDevice.getAllocator().getStats();
+  std::ofstream file{path};
+  writeMemoryStatsJson(stats, file);
+  std::cout << "device memory: " << stats.total.usedBytes / (1024 * 1024) << " MiB used of "
+            << stats.total.reservedBytes / (1024 * 1024) << " MiB in "
+            << stats.total.blockCount + stats.total.dedicatedCount << " allocations, written to "
+            << path << std::endl;
+}
+
+void FirstApp::attachModel(LveGameObject &obj, const LveModelHandle &model) {
+  if (model.isReady()) {
+    obj.model = model.get();
+    return;
+  }
+  obj.model = assetLoader.getPlaceholderModel();
+  model.then([this, id = obj.getId()](const std::shared_ptr<LveModel> &loaded) {
+    auto it = gameObjects.find(id);
+    if (it != gameObjects.end()) it->second.model = loaded;
+  });
+}
+
+void FirstApp::attachTexture(LveGameObject &obj, const LveTextureHandle &texture) {
+  if (texture.isReady()) {
+    obj.texture = texture.get();
+    return;
+  }
+  obj.texture = assetLoader.getPlaceholderTexture();
+  texture.then([this, id = obj.getId()](const std::shared_ptr<Texture> &loaded) {
+    auto it = gameObjects.find(id);
+    if (it != gameObjects.end()) it->second.texture = loaded;
+  });
+}
+
 void FirstApp::loadGameObjects() {
   // Load all body part models
-  std::shared_ptr<LveModel> torsoHead =
-      LveModel::createModelFromFile(lveDevice, "models/Hierarchical_char/head_torso.obj");
-  std::shared_ptr<LveModel> lArm =
-      LveModel::createModelFromFile(lveDevice, "models/Hierarchical_char/right_arm.obj");
-  std::shared_ptr<LveModel> rArm =
-      LveModel::createModelFromFile(lveDevice, "models/Hierarchical_char/left_arm.obj");
-  std::shared_ptr<LveModel> lLeg =
-      LveModel::createModelFromFile(lveDevice, "models/Hierarchical_char/left_leg.obj");
-  std::shared_ptr<LveModel> rLeg =
-      LveModel::createModelFromFile(lveDevice, "models/Hierarchical_char/right_leg.obj");
+  LveModelHandle torsoHead =
+      assetLoader.loadModel("models/Hierarchical_char/head_torso.obj");
+  LveModelHandle lArm =
+      assetLoader.loadModel("models/Hierarchical_char/right_arm.obj");
+  LveModelHandle rArm =
+      assetLoader.loadModel("models/Hierarchical_char/left_arm.obj");
+  LveModelHandle lLeg =
+      assetLoader.loadModel("models/Hierarchical_char/left_leg.obj");
+  LveModelHandle rLeg =
+      assetLoader.loadModel("models/Hierarchical_char/right_leg.obj");
 
   //defualt texture
-  auto defTexture = std::make_shared<Texture>(lveDevice, "../textures/grey.png");
+  auto defTexture = assetLoader.loadTexture("../textures/grey.png");
   //load textures
-  auto lampTexture = std::make_shared<Texture>(lveDevice, "../textures/lamp/lamp_normal.png");
-  auto vaseTexture = std::make_shared<Texture>(lveDevice, "../textures/meme.png");
-  auto floorTexture = std::make_shared<Texture>(lveDevice, "../textures/road.jpg");
-  auto benchT = std::make_shared<Texture>(lveDevice, "../textures/bench/germany010.jpg");
-  auto guyT = std::make_shared<Texture>(lveDevice, "../models/fallguys/shaded.png");
-  auto guyMetallicT = std::make_shared<Texture>(lveDevice, "../models/fallguys/texture_normal.png");
-  auto guyFireT = std::make_shared<Texture>(lveDevice, "../models/fallguys/texture_pbr.png");
+  auto lampTexture = assetLoader.loadTexture("../textures/lamp/lamp_normal.png");
+  auto vaseTexture = assetLoader.loadTexture("../textures/meme.png");
+  auto floorTexture = assetLoader.loadTexture("../textures/road.jpg", LveLoadPriority::High);
+  auto benchT = assetLoader.loadTexture("../textures/bench/germany010.jpg");
+  auto guyT = assetLoader.loadTexture("../models/fallguys/shaded.png");
+  auto guyMetallicT = assetLoader.loadTexture("../models/fallguys/texture_normal.png");
+  auto guyFireT = assetLoader.loadTexture("../models/fallguys/texture_pbr.png");
   // Anim1:Jump
   Animation jumpAnim(
       glm::vec3(0.f, 0.f, 0.f),// Start at ground level
@@ -272,8 +323,8 @@ void FirstApp::loadGameObjects() {
 
   // PARENT: torso and head
   auto torso = LveGameObject::createGameObject();
-  torso.model = torsoHead;
-  torso.texture = guyT;  // Use one of your existing textures
+  attachModel(torso, torsoHead);
+  attachTexture(torso, guyT);  // Use one of your existing textures
   glm::vec3 torsoWorld = {0.f, -1.f, -1.f};
   torso.transform.translation = torsoWorld;  // World position
   torso.transform.scale = {0.1f, 0.1f, 0.1f};      // Adjust if too big/small
@@ -286,8 +337,8 @@ void FirstApp::loadGameObjects() {
 
    //CHILD: left leg
   auto ll = LveGameObject::createGameObject();
-  ll.model = lLeg;
-  ll.texture = guyMetallicT;  // Use one of your existing textures
+  attachModel(ll, lLeg);
+  attachTexture(ll, guyMetallicT);  // Use one of your existing textures
   glm::vec3 llLocal ={0.f, -1.f, -1.f};
   ll.transform.translation = llLocal - torsoWorld;  // World position
   ll.transform.scale = {0.1f, 0.1f, 0.1f};      // Adjust if too big/small
@@ -301,8 +352,8 @@ void FirstApp::loadGameObjects() {
 
   //CHILD: right leg
   auto rl = LveGameObject::createGameObject();
-  rl.model = rLeg;
-  rl.texture = guyMetallicT;  // Use one of your existing textures
+  attachModel(rl, rLeg);
+  attachTexture(rl, guyMetallicT);  // Use one of your existing textures
   glm::vec3 rlLocal ={0.f, -1.f, -1.f};
   rl.transform.translation = rlLocal - torsoWorld;  // World position
   rl.transform.scale = {0.1f, 0.1f, 0.1f};      // Adjust if too big/small
@@ -318,8 +369,8 @@ void FirstApp::loadGameObjects() {
 
   //CHILD: left arm
   auto la = LveGameObject::createGameObject();
-  la.model = lArm;
-  la.texture = guyMetallicT;  // Use one of your existing textures
+  attachModel(la, lArm);
+  attachTexture(la, guyMetallicT);  // Use one of your existing textures
   glm::vec3 laLocal = {0.f, -1.f, -1.f};
   la.transform.translation = laLocal - torsoWorld;  // World position
   la.transform.scale = {0.1f, 0.1f, 0.1f};      // Adjust if too big/small
@@ -335,8 +386,8 @@ void FirstApp::loadGameObjects() {
 
   //CHILD: right arm
   auto ra = LveGameObject::createGameObject();
-  ra.model = rArm;
-  ra.texture = guyMetallicT;  // Use one of your existing textures
+  attachModel(ra, rArm);
+  attachTexture(ra, guyMetallicT);  // Use one of your existing textures
   glm::vec3 raLocal = {0.f, -1.f, -1.f};
   ra.transform.translation = raLocal - torsoWorld;  // World position
   ra.transform.scale = {0.1f, 0.1f, 0.1f};      // Adjust if too big/small
@@ -353,11 +404,11 @@ void FirstApp::loadGameObjects() {
 
 
   //BENCH
-    std::shared_ptr<LveModel> benchModel =
-        LveModel::createModelFromFile(lveDevice, "models/objBench.obj"); // Adjust filename as needed
+    LveModelHandle benchModel =
+        assetLoader.loadModel("models/objBench.obj"); // Adjust filename as needed
     auto bench = LveGameObject::createGameObject();
-    bench.model = benchModel;
-    bench.texture = benchT;
+    attachModel(bench, benchModel);
+    attachTexture(bench, benchT);
     bench.transform.translation = {0.f, 0.5f, 0.f}; // Centered on the floor
     bench.transform.rotation = {glm::pi<float>(), 0.f, 0.f};
     bench.transform.scale = {0.25f, 0.25f, 0.25f}; // Adjust scale as needed
@@ -369,10 +420,10 @@ void FirstApp::loadGameObjects() {
     gameObjects.emplace(bench.getId(), std::move(bench));
 
   //TRASH CAN
-  std::shared_ptr<LveModel> binOBJ =
-      LveModel::createModelFromFile(lveDevice, "models/outdoorBin.obj");
+  LveModelHandle binOBJ =
+      assetLoader.loadModel("models/outdoorBin.obj");
   auto trashCan = LveGameObject::createGameObject();
-  trashCan.model = binOBJ;
+  attachModel(trashCan, binOBJ);
   //trashCan.texture = defTexture;
   trashCan.transform.translation = {1.7f, .03f, 0.f};
   trashCan.transform.rotation = {glm::pi<float>(), 0.f, 0.f};
@@ -386,11 +437,11 @@ void FirstApp::loadGameObjects() {
   gameObjects.emplace(trashCan.getId(), std::move(trashCan));
 
   //VASE WITH TEXTURE
-  std::shared_ptr<LveModel> flat_vase =
-      LveModel::createModelFromFile(lveDevice, "models/flat_vase.obj");
+  LveModelHandle flat_vase =
+      assetLoader.loadModel("models/flat_vase.obj");
   auto flatVase = LveGameObject::createGameObject();
-  flatVase.model = flat_vase;
-  flatVase.texture = vaseTexture;
+  attachModel(flatVase, flat_vase);
+  attachTexture(flatVase, vaseTexture);
   flatVase.transform.translation = {-1.7f, .5f, 0.f};
   flatVase.transform.scale = {3.f, 1.5f, 3.f};
 //  flatVase.anim = std::make_unique<AnimationController>(
@@ -403,10 +454,10 @@ void FirstApp::loadGameObjects() {
 
 
   //FALL GUY
-  std::shared_ptr<LveModel> fallGuy = LveModel::createModelFromFile(lveDevice, "models/fallguys/base.obj");
+  LveModelHandle fallGuy = assetLoader.loadModel("models/fallguys/base.obj");
   auto guy = LveGameObject::createGameObject();
-  guy.model = fallGuy;
-  guy.texture = guyFireT;
+  attachModel(guy, fallGuy);
+  attachTexture(guy, guyFireT);
   guy.transform.translation = {0, 0.5f, 2.9f};
   guy.transform.rotation = {glm::pi<float>(), 0.f, 0.f};
   guy.transform.scale = {1.0f, 1.0f, 1.0f};
@@ -420,33 +471,33 @@ void FirstApp::loadGameObjects() {
   gameObjects.emplace(guy.getId(), std::move(guy));
 
   //FALL GUY
-  auto ccT = std::make_shared<Texture>(lveDevice, "../models/crust_crab/shaded.png");
-  std::shared_ptr<LveModel> crustyCrab = LveModel::createModelFromFile(lveDevice, "models/crust_crab/base.obj");
+  auto ccT = assetLoader.loadTexture("../models/crust_crab/shaded.png");
+  LveModelHandle crustyCrab = assetLoader.loadModel("models/crust_crab/base.obj");
   auto cc = LveGameObject::createGameObject();
-  cc.model = crustyCrab;
-  cc.texture = ccT;
+  attachModel(cc, crustyCrab);
+  attachTexture(cc, ccT);
   cc.transform.translation = {0, 0.5f, 7.f};
   cc.transform.rotation = {glm::pi<float>(), 0.f, 0.f};
   cc.transform.scale = {5.0f, 5.0f, 5.0f};
   gameObjects.emplace(cc.getId(), std::move(cc));
 
   //PATH FLOOR FOR ZOMBIES
-  std::shared_ptr<LveModel> Quad2= LveModel::createModelFromFile(lveDevice, "models/quad.obj");
+  LveModelHandle Quad2= assetLoader.loadModel("models/quad.obj", LveLoadPriority::High);
   auto floor2 = LveGameObject::createGameObject();
-  floor2.model = Quad2;
-  floor2.texture = floorTexture;
+  attachModel(floor2, Quad2);
+  attachTexture(floor2, floorTexture);
   floor2.transform.translation = {0.f, .5f, -6.f};
   floor2.transform.scale = {3.f, 1.f, 3.f};
   gameObjects.emplace(floor2.getId(), std::move(floor2));
 
   // PARENT ZOMBIE
-  auto zT = std::make_shared<Texture>(lveDevice, "../models/zombie/shaded.png");
-  std::shared_ptr<LveModel> zombie = LveModel::createModelFromFile(lveDevice, "models/zombie/base.obj");
+  auto zT = assetLoader.loadTexture("../models/zombie/shaded.png");
+  LveModelHandle zombie = assetLoader.loadModel("models/zombie/base.obj");
 
   auto zParent = LveGameObject::createGameObject();
   glm::vec3 parentWorld = {0.f, 0.5f, -7.f};  // Parent's world position
-  zParent.model = zombie;
-  zParent.texture = zT;
+  attachModel(zParent, zombie);
+  attachTexture(zParent, zT);
   zParent.transform.translation = parentWorld;
   zParent.transform.rotation = {0.f, 0.f, glm::pi<float>()};
   zParent.transform.scale = {1.0f, 1.0f, 1.0f};
@@ -459,8 +510,8 @@ void FirstApp::loadGameObjects() {
   // LEFT ZOMBIE CHILD
   auto zchildL = LveGameObject::createGameObject();
   glm::vec3 childLWorld = {-1.f, 0.5f, -7.5f};  // Current world position
-  zchildL.model = zombie;
-  zchildL.texture = zT;
+  attachModel(zchildL, zombie);
+  attachTexture(zchildL, zT);
   zchildL.transform.translation = childLWorld - parentWorld;  // Convert to local space
   zchildL.transform.rotation = {0.f, 0.f, 0.f};
   zchildL.transform.scale = {0.5f, 0.5f, 0.5f};
@@ -475,8 +526,8 @@ void FirstApp::loadGameObjects() {
   // RIGHT ZOMBIE CHILD
   auto zchildR = LveGameObject::createGameObject();
   glm::vec3 childRWorld = {1.f, 0.5f, -7.5f};  // Current world position
-  zchildR.model = zombie;
-  zchildR.texture = zT;
+  attachModel(zchildR, zombie);
+  attachTexture(zchildR, zT);
   zchildR.transform.translation = childRWorld - parentWorld;  // Convert to local space
   zchildR.transform.rotation = {0.f, 0.f, 0.f};
   zchildR.transform.scale = {0.5f, 0.5f, 0.5f};
@@ -491,8 +542,8 @@ void FirstApp::loadGameObjects() {
   // BACK ZOMBIE CHILD
   auto zchildB = LveGameObject::createGameObject();
   glm::vec3 childBWorld = {0.f, 0.5f, -8.5f};  // Current world position
-  zchildB.model = zombie;
-  zchildB.texture = zT;
+  attachModel(zchildB, zombie);
+  attachTexture(zchildB, zT);
   zchildB.transform.translation = childBWorld - parentWorld;  // Convert to local space
   zchildB.transform.rotation = {0.f, 0.f, 0.f};
   zchildB.transform.scale = {0.5f, 0.5f, 0.5f};
@@ -503,10 +554,10 @@ void FirstApp::loadGameObjects() {
   gameObjects.at(zParentId).addchild(zchildBId);
   //LAMPS FOR EACH CORNER
     //bottom right corner
-    std::shared_ptr<LveModel> Lamp = LveModel::createModelFromFile(lveDevice, "models/Street_Lamp.obj");
+    LveModelHandle Lamp = assetLoader.loadModel("models/Street_Lamp.obj");
     auto lamp = LveGameObject::createGameObject();
-    lamp.model = Lamp;
-    lamp.texture = lampTexture;
+    attachModel(lamp, Lamp);
+    attachTexture(lamp, lampTexture);
     lamp.transform.translation = {-2.9f, 0.5f, -2.9f};
     lamp.transform.rotation = {glm::pi<float>(), 0.f, 0.f};
     lamp.transform.scale = {0.01f, 0.01f, 0.01f};
@@ -514,8 +565,8 @@ void FirstApp::loadGameObjects() {
 
     //bottom right corner zombies
     auto lampZ = LveGameObject::createGameObject();
-    lampZ.model = Lamp;
-    lampZ.texture = lampTexture;
+    attachModel(lampZ, Lamp);
+    attachTexture(lampZ, lampTexture);
     lampZ.transform.translation = {-2.9f, 0.5f, -8.9f};
     lampZ.transform.rotation = {glm::pi<float>(), 0.f, 0.f};
     lampZ.transform.scale = {0.01f, 0.01f, 0.01f};
@@ -523,8 +574,8 @@ void FirstApp::loadGameObjects() {
 
     //bottom left
     auto lamp2 = LveGameObject::createGameObject();
-    lamp2.model = Lamp;
-    lamp2.texture = lampTexture;
+    attachModel(lamp2, Lamp);
+    attachTexture(lamp2, lampTexture);
     lamp2.transform.translation = {2.9f, 0.5f, -2.9f};  // Bottom-left (flip X)
     lamp2.transform.rotation = {glm::pi<float>(), 0.f, 0.f};
     lamp2.transform.scale = {0.01f, 0.01f, 0.01f};
@@ -541,8 +592,8 @@ void FirstApp::loadGameObjects() {
 
     //top right
     auto lamp3 = LveGameObject::createGameObject();
-    lamp3.model = Lamp;
-    lamp3.texture = lampTexture;
+    attachModel(lamp3, Lamp);
+    attachTexture(lamp3, lampTexture);
     lamp3.transform.translation = {-2.9f, 0.5f, 2.9f};  // Top-right (flip Z)
     lamp3.transform.rotation = {glm::pi<float>(), 0.f, 0.f};
     lamp3.transform.scale = {0.01f, 0.01f, 0.01f};
@@ -550,18 +601,18 @@ void FirstApp::loadGameObjects() {
 
     //top left
     auto lamp4 = LveGameObject::createGameObject();
-    lamp4.model = Lamp;
-    lamp4.texture = lampTexture;
+    attachModel(lamp4, Lamp);
+    attachTexture(lamp4, lampTexture);
     lamp4.transform.translation = {2.9f, 0.5f, 2.9f};  // Top-left (flip both X and Z)
     lamp4.transform.rotation = {glm::pi<float>(), 0.f, 0.f};
     lamp4.transform.scale = {0.01f, 0.01f, 0.01f};
     gameObjects.emplace(lamp4.getId(), std::move(lamp4));
 
     //PATH FLOOR
-    std::shared_ptr<LveModel> Quad= LveModel::createModelFromFile(lveDevice, "models/quad.obj");
+    LveModelHandle Quad= assetLoader.loadModel("models/quad.obj", LveLoadPriority::High);
   auto floor = LveGameObject::createGameObject();
-  floor.model = Quad;
-  floor.texture = floorTexture;
+  attachModel(floor, Quad);
+  attachTexture(floor, floorTexture);
   floor.transform.translation = {0.f, .5f, 0.f};
   floor.transform.scale = {3.f, 1.f, 3.f};
   gameObjects.emplace(floor.getId(), std::move(floor));
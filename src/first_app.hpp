@@ -1,5 +1,7 @@
 #pragma once
 
+#include "lve/lve_asset_loader.hpp"
+#include "lve/lve_asset_registry.hpp"
 #include "lve/lve_descriptors.hpp"
 #include "lve/lve_device.hpp"
 #include "lve/lve_game_object.hpp"
@@ -8,6 +10,7 @@
 
 // std
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace lve {
@@ -26,6 +29,11 @@ class FirstApp {
 
  private:
   void loadGameObjects();
+  // show the placeholder on obj until the asset is in, then swap it in by id
+  void attachModel(LveGameObject &obj, const LveModelHandle &model);
+  void attachTexture(LveGameObject &obj, const LveTextureHandle &texture);
+  // writes LveAllocator::getStats() to path as JSON and prints the totals
+  void dumpMemoryStats(const std::string &path);
 
   LveWindow lveWindow{WIDTH, HEIGHT, "Vulkan Tutorial"};
   LveDevice lveDevice{lveWindow};
@@ -33,6 +41,8 @@ class FirstApp {
 
   // note: order of declarations matters
   std::unique_ptr<LveDescriptorPool> globalPool{};
+  LveAssetRegistry assetRegistry{lveDevice};
+  LveAssetLoader assetLoader{lveDevice, assetRegistry};
   LveGameObject::Map gameObjects;
 };
 }  // namespace lve
@@ -0,0 +1,450 @@
+#include "lve_allocator.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace lve {
+
+namespace {
+
+// heaps smaller than this get blocks of an eighth of their size instead
+constexpr VkDeviceSize kLargeHeapSize = 1024ull * 1024 * 1024;
+constexpr VkDeviceSize kBlockSize = 64ull * 1024 * 1024;
+
+VkDeviceSize alignDown(VkDeviceSize value, VkDeviceSize alignment) {
+  return value / alignment * alignment;
+}
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+size_t poolIndex(uint32_t memoryType, LveAllocator::ResourceKind kind) {
+  return memoryType * 2 + (kind == LveAllocator::ResourceKind::Image ? 1 : 0);
+}
+
+}  // namespace
+
+LveAllocator::LveAllocator(
+    VkDevice device, VkPhysicalDevice physicalDevice, uint32_t apiVersion, bool memoryBudget)
+    : device{device}, physicalDevice{physicalDevice}, memoryBudget{memoryBudget} {
+  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+  nonCoherentAtomSize = std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+  dedicatedQueries = apiVersion >= VK_API_VERSION_1_1;
+}
+
+LveAllocator::~LveAllocator() {
+  for (auto &pool : pools) {
+    for (auto &block : pool) {
+      assert(block->ranges.isEmpty() && "Memory block still has allocations");
+      vkFreeMemory(device, block->memory, nullptr);
+    }
+  }
+  for (auto &usage : typeUsage) {
+    assert(usage.dedicatedCount == 0 && "Dedicated allocations were not freed");
+  }
+}
+
+LveAllocation LveAllocator::allocateForBuffer(
+    VkBuffer buffer, VkMemoryPropertyFlags properties, LveMemoryCategory category) {
+  VkMemoryRequirements requirements;
+  bool dedicated = false;
+  if (dedicatedQueries) {
+    VkMemoryDedicatedRequirements dedicatedRequirements{};
+    dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+    VkMemoryRequirements2 requirements2{};
+    requirements2.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    requirements2.pNext = &dedicatedRequirements;
+    VkBufferMemoryRequirementsInfo2 info{};
+    info.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+    info.buffer = buffer;
+    vkGetBufferMemoryRequirements2(device, &info, &requirements2);
+    requirements = requirements2.memoryRequirements;
+    dedicated = dedicatedRequirements.prefersDedicatedAllocation ||
+                dedicatedRequirements.requiresDedicatedAllocation;
+  } else {
+    vkGetBufferMemoryRequirements(device, buffer, &requirements);
+  }
+
+  VkMemoryDedicatedAllocateInfo dedicatedInfo{};
+  dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+  dedicatedInfo.buffer = buffer;
+  LveAllocation allocation = allocate(
+      requirements,
+      properties,
+      ResourceKind::Buffer,
+      category,
+      dedicated,
+      dedicatedQueries ? &dedicatedInfo : nullptr);
+
+  if (vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset) != VK_SUCCESS) {
+    free(allocation);
+    throw std::runtime_error("failed to bind buffer memory!");
+  }
+  return allocation;
+}
+
+LveAllocation LveAllocator::allocateForImage(
+    VkImage image, VkMemoryPropertyFlags properties, LveMemoryCategory category) {
+  VkMemoryRequirements requirements;
+  bool dedicated = false;
+  if (dedicatedQueries) {
+    VkMemoryDedicatedRequirements dedicatedRequirements{};
+    dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+    VkMemoryRequirements2 requirements2{};
+    requirements2.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    requirements2.pNext = &dedicatedRequirements;
+    VkImageMemoryRequirementsInfo2 info{};
+    info.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+    info.image = image;
+    vkGetImageMemoryRequirements2(device, &info, &requirements2);
+    requirements = requirements2.memoryRequirements;
+    dedicated = dedicatedRequirements.prefersDedicatedAllocation ||
+                dedicatedRequirements.requiresDedicatedAllocation;
+  } else {
+    vkGetImageMemoryRequirements(device, image, &requirements);
+  }
+
+  VkMemoryDedicatedAllocateInfo dedicatedInfo{};
+  dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+  dedicatedInfo.image = image;
+  LveAllocation allocation = allocate(
+      requirements,
+      properties,
+      ResourceKind::Image,
+      category,
+      dedicated,
+      dedicatedQueries ? &dedicatedInfo : nullptr);
+
+  if (vkBindImageMemory(device, image, allocation.memory, allocation.offset) != VK_SUCCESS) {
+    free(allocation);
+    throw std::runtime_error("failed to bind image memory!");
+  }
+  return allocation;
+}
+
+LveAllocation LveAllocator::allocate(
+    const VkMemoryRequirements &requirements,
+    VkMemoryPropertyFlags properties,
+    ResourceKind kind,
+    LveMemoryCategory category,
+    bool dedicated,
+    const VkMemoryDedicatedAllocateInfo *dedicatedInfo) {
+  uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+
+  // flushes work in whole atoms, so non-coherent allocations must not share one
+  VkDeviceSize alignment = requirements.alignment;
+  VkDeviceSize size = requirements.size;
+  if (isNonCoherent(memoryType)) {
+    alignment = std::max(alignment, nonCoherentAtomSize);
+    size = alignUp(size, nonCoherentAtomSize);
+  }
+
+  std::lock_guard<std::mutex> lock{mutex};
+  VkDeviceSize blockSize = getBlockSize(memoryType);
+  if (dedicated || size > blockSize / 2) {
+    LveAllocation allocation = allocateDedicated(size, memoryType, dedicatedInfo);
+    allocation.category = category;
+    trackUse(allocation, true);
+    return allocation;
+  }
+
+  LveAllocation allocation{};
+  allocation.size = size;
+  allocation.memoryType = memoryType;
+  allocation.category = category;
+
+  auto &pool = pools[poolIndex(memoryType, kind)];
+  for (auto &block : pool) {
+    if (block->evacuating) continue;
+    uint64_t offset = block->ranges.allocate(size, alignment);
+    if (offset != LveRangeAllocator::kInvalidOffset) {
+      allocation.memory = block->memory;
+      allocation.offset = offset;
+      allocation.mapped = block->mapped != nullptr ? block->mapped + offset : nullptr;
+      allocation.block = block.get();
+      trackUse(allocation, true);
+      return allocation;
+    }
+  }
+
+  uint8_t *mapped = nullptr;
+  VkDeviceMemory memory = allocateDeviceMemory(blockSize, memoryType, nullptr, mapped);
+  if (memory == VK_NULL_HANDLE) {
+    // the heap may not have a whole block left, the resource alone might still fit
+    allocation = allocateDedicated(size, memoryType, dedicatedInfo);
+    allocation.category = category;
+    trackUse(allocation, true);
+    return allocation;
+  }
+  typeUsage[memoryType].reservedBytes += blockSize;
+  typeUsage[memoryType].blockCount++;
+  pool.push_back(std::make_unique<LveMemoryBlock>(
+      memory, blockSize, mapped, static_cast<uint32_t>(poolIndex(memoryType, kind))));
+  LveMemoryBlock *block = pool.back().get();
+
+  allocation.memory = memory;
+  allocation.offset = block->ranges.allocate(size, alignment);
+  allocation.mapped = mapped;
+  allocation.block = block;
+  trackUse(allocation, true);
+  return allocation;
+}
+
+LveAllocation LveAllocator::allocateDedicated(
+    VkDeviceSize size, uint32_t memoryType, const VkMemoryDedicatedAllocateInfo *dedicatedInfo) {
+  LveAllocation allocation{};
+  allocation.size = size;
+  allocation.memoryType = memoryType;
+  allocation.memory = allocateDeviceMemory(size, memoryType, dedicatedInfo, allocation.mapped);
+  if (allocation.memory == VK_NULL_HANDLE) {
+    throw std::runtime_error("failed to allocate device memory!");
+  }
+  typeUsage[memoryType].reservedBytes += size;
+  typeUsage[memoryType].dedicatedCount++;
+  return allocation;
+}
+
+VkDeviceMemory LveAllocator::allocateDeviceMemory(
+    VkDeviceSize size, uint32_t memoryType, const void *pNext, uint8_t *&mapped) {
+  VkMemoryAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  allocInfo.pNext = pNext;
+  allocInfo.allocationSize = size;
+  allocInfo.memoryTypeIndex = memoryType;
+
+  VkDeviceMemory memory;
+  if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+    return VK_NULL_HANDLE;
+  }
+
+  // a memory object can only be mapped once, so everything host visible is mapped up front
+  mapped = nullptr;
+  if (memoryProperties.memoryTypes[memoryType].propertyFlags &
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+    void *data;
+    if (vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS) {
+      vkFreeMemory(device, memory, nullptr);
+      return VK_NULL_HANDLE;
+    }
+    mapped = static_cast<uint8_t *>(data);
+  }
+  return memory;
+}
+
+void LveAllocator::free(LveAllocation &allocation) {
+  if (allocation.memory == VK_NULL_HANDLE) return;
+
+  std::lock_guard<std::mutex> lock{mutex};
+  trackUse(allocation, false);
+  if (allocation.block == nullptr) {
+    vkFreeMemory(device, allocation.memory, nullptr);
+    typeUsage[allocation.memoryType].reservedBytes -= allocation.size;
+    typeUsage[allocation.memoryType].dedicatedCount--;
+    allocation = {};
+    return;
+  }
+
+  LveMemoryBlock *block = allocation.block;
+  uint32_t memoryType = allocation.memoryType;
+  block->ranges.free(allocation.offset, allocation.size);
+  allocation = {};
+  if (!block->ranges.isEmpty()) return;
+
+  // one empty block stays around per pool, so a resource that comes and goes does not allocate
+  // and free a whole block every time
+  auto &pool = pools[block->pool];
+  size_t emptyBlocks = std::count_if(pool.begin(), pool.end(), [](const auto &candidate) {
+    return candidate->ranges.isEmpty();
+  });
+  if (emptyBlocks > 1) {
+    typeUsage[memoryType].reservedBytes -= block->ranges.getCapacity();
+    typeUsage[memoryType].blockCount--;
+    vkFreeMemory(device, block->memory, nullptr);
+    pool.erase(std::find_if(pool.begin(), pool.end(), [block](const auto &candidate) {
+      return candidate.get() == block;
+    }));
+  }
+}
+
+void LveAllocator::beginDefragmentation(const std::vector<const LveAllocation *> &movable) {
+  std::unordered_map<const LveMemoryBlock *, VkDeviceSize> movableSize;
+  for (const LveAllocation *allocation : movable) {
+    if (allocation->block != nullptr) movableSize[allocation->block] += allocation->size;
+  }
+
+  std::lock_guard<std::mutex> lock{mutex};
+  for (auto &pool : pools) {
+    if (pool.size() < 2) continue;
+    std::vector<const LveRangeAllocator *> ranges;
+    std::vector<bool> pinned;
+    for (auto &block : pool) {
+      ranges.push_back(&block->ranges);
+      VkDeviceSize used = block->ranges.getCapacity() - block->ranges.getFreeSize();
+      auto it = movableSize.find(block.get());
+      pinned.push_back(used != (it != movableSize.end() ? it->second : 0));
+    }
+    for (size_t i : selectAllocatorsToEvacuate(ranges, pinned)) {
+      pool[i]->evacuating = true;
+    }
+  }
+}
+
+uint32_t LveAllocator::endDefragmentation() {
+  std::lock_guard<std::mutex> lock{mutex};
+  uint32_t released = 0;
+  for (auto &pool : pools) {
+    for (auto it = pool.begin(); it != pool.end();) {
+      LveMemoryBlock &block = **it;
+      if (!block.evacuating || !block.ranges.isEmpty()) {
+        block.evacuating = false;
+        ++it;
+        continue;
+      }
+      uint32_t memoryType = block.pool / 2;
+      typeUsage[memoryType].reservedBytes -= block.ranges.getCapacity();
+      typeUsage[memoryType].blockCount--;
+      vkFreeMemory(device, block.memory, nullptr);
+      it = pool.erase(it);
+      released++;
+    }
+  }
+  return released;
+}
+
+VkResult LveAllocator::flush(
+    const LveAllocation &allocation, VkDeviceSize size, VkDeviceSize offset) {
+  if (!isNonCoherent(allocation.memoryType)) return VK_SUCCESS;
+  VkMappedMemoryRange range = getMappedRange(allocation, size, offset);
+  return vkFlushMappedMemoryRanges(device, 1, &range);
+}
+
+VkResult LveAllocator::invalidate(
+    const LveAllocation &allocation, VkDeviceSize size, VkDeviceSize offset) {
+  if (!isNonCoherent(allocation.memoryType)) return VK_SUCCESS;
+  VkMappedMemoryRange range = getMappedRange(allocation, size, offset);
+  return vkInvalidateMappedMemoryRanges(device, 1, &range);
+}
+
+VkMappedMemoryRange LveAllocator::getMappedRange(
+    const LveAllocation &allocation, VkDeviceSize size, VkDeviceSize offset) const {
+  // widened to whole atoms, the allocation itself starts and ends on atom boundaries
+  VkDeviceSize end = size == VK_WHOLE_SIZE ? allocation.size : offset + size;
+  VkMappedMemoryRange range{};
+  range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+  range.memory = allocation.memory;
+  range.offset = allocation.offset + alignDown(offset, nonCoherentAtomSize);
+  range.size = std::min(alignUp(end, nonCoherentAtomSize), allocation.size) -
+               alignDown(offset, nonCoherentAtomSize);
+  return range;
+}
+
+uint32_t LveAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+  for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+    if ((typeFilter & (1 << i)) &&
+        (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+      return i;
+    }
+  }
+
+  throw std::runtime_error("failed to find suitable memory type!");
+}
+
+uint32_t LveAllocator::getDeviceMemoryCount() const {
+  std::lock_guard<std::mutex> lock{mutex};
+  uint32_t count = 0;
+  for (auto &usage : typeUsage) {
+    count += usage.blockCount + usage.dedicatedCount;
+  }
+  return count;
+}
+
+VkDeviceSize LveAllocator::getBlockFreeSize() const {
+  std::lock_guard<std::mutex> lock{mutex};
+  VkDeviceSize free = 0;
+  for (auto &pool : pools) {
+    for (auto &block : pool) {
+      free += block->ranges.getFreeSize();
+    }
+  }
+  return free;
+}
+
+LveMemoryStats LveAllocator::getStats() const {
+  LveMemoryStats stats{};
+  stats.heaps.resize(memoryProperties.memoryHeapCount);
+  stats.types.resize(memoryProperties.memoryTypeCount);
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+      stats.types[i].usage = typeUsage[i];
+    }
+    stats.categories = categoryUsage;
+  }
+
+  for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+    stats.heaps[i].size = memoryProperties.memoryHeaps[i].size;
+    stats.heaps[i].flags = memoryProperties.memoryHeaps[i].flags;
+  }
+  for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+    LveMemoryStats::Type &type = stats.types[i];
+    type.flags = memoryProperties.memoryTypes[i].propertyFlags;
+    type.heapIndex = memoryProperties.memoryTypes[i].heapIndex;
+    for (LveMemoryStats::Usage *sum : {&stats.heaps[type.heapIndex].usage, &stats.total}) {
+      sum->reservedBytes += type.usage.reservedBytes;
+      sum->usedBytes += type.usage.usedBytes;
+      sum->allocationCount += type.usage.allocationCount;
+      sum->blockCount += type.usage.blockCount;
+      sum->dedicatedCount += type.usage.dedicatedCount;
+    }
+  }
+
+  VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+  if (memoryBudget) {
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    VkPhysicalDeviceMemoryProperties2 properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    properties2.pNext = &budgetProperties;
+    vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &properties2);
+    stats.budgetAvailable = true;
+  }
+  for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+    LveMemoryStats::Heap &heap = stats.heaps[i];
+    heap.budget = memoryBudget ? budgetProperties.heapBudget[i] : heap.size;
+    heap.driverUsage = memoryBudget ? budgetProperties.heapUsage[i] : heap.usage.reservedBytes;
+  }
+  return stats;
+}
+
+void LveAllocator::trackUse(const LveAllocation &allocation, bool allocated) {
+  for (LveMemoryStats::Usage *usage :
+       {&typeUsage[allocation.memoryType],
+        &categoryUsage[static_cast<size_t>(allocation.category)]}) {
+    if (allocated) {
+      usage->usedBytes += allocation.size;
+      usage->allocationCount++;
+    } else {
+      usage->usedBytes -= allocation.size;
+      usage->allocationCount--;
+    }
+  }
+}
+
+VkDeviceSize LveAllocator::getBlockSize(uint32_t memoryType) const {
+  const VkMemoryHeap &heap =
+      memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryType].heapIndex];
+  return heap.size < kLargeHeapSize ? heap.size / 8 : kBlockSize;
+}
+
+bool LveAllocator::isNonCoherent(uint32_t memoryType) const {
+  VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[memoryType].propertyFlags;
+  return (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+         !(flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+}
+
+}  // namespace lve
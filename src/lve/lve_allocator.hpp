@@ -0,0 +1,146 @@
+#pragma once
+
+#include "lve_memory_stats.hpp"
+#include "lve_range_allocator.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+
+struct LveMemoryBlock;
+
+// where a buffer or image lives, returned by LveAllocator and handed back to it to free
+struct LveAllocation {
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  VkDeviceSize offset = 0;
+  VkDeviceSize size = 0;
+  // host visible memory stays mapped as long as it exists, this points at offset
+  uint8_t *mapped = nullptr;
+  uint32_t memoryType = 0;
+  LveMemoryCategory category = LveMemoryCategory::Other;
+  // nullptr for a dedicated allocation that owns its memory
+  LveMemoryBlock *block = nullptr;
+};
+
+// one vkAllocateMemory that allocations of a single memory type are carved out of
+struct LveMemoryBlock {
+  LveMemoryBlock(VkDeviceMemory memory, VkDeviceSize size, uint8_t *mapped, uint32_t pool)
+      : memory{memory}, mapped{mapped}, pool{pool}, ranges{size} {}
+
+  VkDeviceMemory memory;
+  uint8_t *mapped;
+  uint32_t pool;
+  LveRangeAllocator ranges;
+  // picked by beginDefragmentation(), nothing new is allocated from it until it is empty
+  bool evacuating = false;
+};
+
+/**
+ * Sub-allocates device memory so a buffer or image no longer costs a vkAllocateMemory of its own.
+ * Drivers cap the number of live allocations (maxMemoryAllocationCount, 4096 on many) and every
+ * allocation is slow, so resources share large blocks per memory type instead. Buffers and
+ * optimal tiling images get separate blocks, so bufferImageGranularity never has to be padded
+ * for. Resources the driver wants alone, and anything larger than half a block, still get a
+ * dedicated allocation. Thread safe.
+ */
+class LveAllocator {
+ public:
+  enum class ResourceKind { Buffer, Image };
+
+  // apiVersion: what the device may be used with, see LveDevice::getApiVersion()
+  // memoryBudget: VK_EXT_memory_budget is enabled, getStats() reports the driver's numbers
+  LveAllocator(
+      VkDevice device,
+      VkPhysicalDevice physicalDevice,
+      uint32_t apiVersion,
+      bool memoryBudget = false);
+  ~LveAllocator();
+
+  LveAllocator(const LveAllocator &) = delete;
+  LveAllocator &operator=(const LveAllocator &) = delete;
+
+  // allocates memory for the buffer and binds it, throws if no memory type has properties
+  LveAllocation allocateForBuffer(
+      VkBuffer buffer,
+      VkMemoryPropertyFlags properties,
+      LveMemoryCategory category = LveMemoryCategory::Other);
+  // the same for an image, optimal tiling is assumed
+  LveAllocation allocateForImage(
+      VkImage image,
+      VkMemoryPropertyFlags properties,
+      LveMemoryCategory category = LveMemoryCategory::Other);
+  // the resource using it has to be destroyed (or at least no longer in use) already
+  void free(LveAllocation &allocation);
+
+  /**
+   * Defragmentation, main thread only. Marks the emptiest blocks of every pool whose allocations
+   * fit into the others, which then no longer take new allocations. The owners of allocations in
+   * them move their resources by allocating anew and copying on the GPU, see isEvacuating().
+   * Only blocks holding nothing but movable allocations are picked, a block with anything else in
+   * it could never be emptied. endDefragmentation() releases the blocks that were emptied,
+   * returns how many.
+   */
+  void beginDefragmentation(const std::vector<const LveAllocation *> &movable);
+  bool isEvacuating(const LveAllocation &allocation) const {
+    return allocation.block != nullptr && allocation.block->evacuating;
+  }
+  uint32_t endDefragmentation();
+
+  // no-ops on coherent memory, ranges are relative to the allocation
+  VkResult flush(
+      const LveAllocation &allocation, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+  VkResult invalidate(
+      const LveAllocation &allocation, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+
+  uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+  // how many vkAllocateMemory calls are live right now, blocks and dedicated allocations
+  uint32_t getDeviceMemoryCount() const;
+  // unused space inside blocks, what defragmentation could at best give back
+  VkDeviceSize getBlockFreeSize() const;
+  // per heap, memory type and category, queries the heap budgets when the extension is enabled
+  LveMemoryStats getStats() const;
+
+ private:
+  LveAllocation allocate(
+      const VkMemoryRequirements &requirements,
+      VkMemoryPropertyFlags properties,
+      ResourceKind kind,
+      LveMemoryCategory category,
+      bool dedicated,
+      const VkMemoryDedicatedAllocateInfo *dedicatedInfo);
+  LveAllocation allocateDedicated(
+      VkDeviceSize size, uint32_t memoryType, const VkMemoryDedicatedAllocateInfo *dedicatedInfo);
+  VkDeviceMemory allocateDeviceMemory(
+      VkDeviceSize size, uint32_t memoryType, const void *pNext, uint8_t *&mapped);
+  VkDeviceSize getBlockSize(uint32_t memoryType) const;
+  bool isNonCoherent(uint32_t memoryType) const;
+  VkMappedMemoryRange getMappedRange(
+      const LveAllocation &allocation, VkDeviceSize size, VkDeviceSize offset) const;
+
+  // keeps the per type and per category numbers of getStats() up to date
+  void trackUse(const LveAllocation &allocation, bool allocated);
+
+  VkDevice device;
+  VkPhysicalDevice physicalDevice;
+  bool memoryBudget;
+  VkPhysicalDeviceMemoryProperties memoryProperties;
+  VkDeviceSize nonCoherentAtomSize;
+  // vkGet*MemoryRequirements2 and dedicated allocations are core since Vulkan 1.1
+  bool dedicatedQueries;
+
+  mutable std::mutex mutex;
+  // index memoryType * 2 + kind, blocks are never moved so allocations can point at them
+  std::array<std::vector<std::unique_ptr<LveMemoryBlock>>, VK_MAX_MEMORY_TYPES * 2> pools;
+  std::array<LveMemoryStats::Usage, VK_MAX_MEMORY_TYPES> typeUsage{};
+  std::array<LveMemoryStats::Usage, kMemoryCategoryCount> categoryUsage{};
+};
+
+}  // namespace lve
@@ -0,0 +1,239 @@
+#include "lve_asset_loader.hpp"
+
+#include "lve_thread_pool.hpp"
+
+// std
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+#ifndef ENGINE_DIR
+#define ENGINE_DIR "../"
+#endif
+
+namespace lve {
+
+namespace {
+
+std::string requestKey(LveAssetRequest::Type type, const std::string &filepath) {
+  return (type == LveAssetRequest::Type::Model ? "model:" : "texture:") + filepath;
+}
+
+// most urgent first, oldest first within a priority
+bool isMoreUrgent(const LveAssetRequest &a, const LveAssetRequest &b) {
+  LveLoadPriority priorityA = a.priority.load();
+  LveLoadPriority priorityB = b.priority.load();
+  if (priorityA != priorityB) return priorityA > priorityB;
+  return a.sequence < b.sequence;
+}
+
+}  // namespace
+
+LveAssetLoader::LveAssetLoader(LveDevice &device, LveAssetRegistry &registry)
+    : lveDevice{device}, registry{registry}, stagingPool{device} {
+  Texture::ImageData grey{};
+  grey.width = 1;
+  grey.height = 1;
+  grey.pixels.reset(new uint8_t[4]{128, 128, 128, 255}, std::default_delete<uint8_t[]>());
+  placeholderTexture = std::make_shared<Texture>(
+      lveDevice, grey, registry.getSamplerCache(), registry.getUploadContext());
+}
+
+LveAssetLoader::~LveAssetLoader() {
+  std::unique_lock<std::mutex> lock{mutex};
+  for (auto &request : queued) {
+    LveLoadStatus expected = LveLoadStatus::Queued;
+    request->status.compare_exchange_strong(expected, LveLoadStatus::Cancelled);
+  }
+  workerDone.wait(lock, [this]() { return activeJobs == 0; });
+  // handles may keep their request alive, but not the staging memory in it
+  for (auto &request : completed) {
+    request->imageData = {};
+  }
+  // the placeholder may still be uploading
+  registry.getUploadContext().waitIdle();
+}
+
+LveModelHandle LveAssetLoader::loadModel(const std::string &filepath, LveLoadPriority priority) {
+  return LveModelHandle{submitRequest(LveAssetRequest::Type::Model, filepath, priority)};
+}
+
+LveTextureHandle LveAssetLoader::loadTexture(
+    const std::string &filepath, LveLoadPriority priority) {
+  return LveTextureHandle{submitRequest(LveAssetRequest::Type::Texture, filepath, priority)};
+}
+
+std::shared_ptr<LveAssetRequest> LveAssetLoader::submitRequest(
+    LveAssetRequest::Type type, const std::string &filepath, LveLoadPriority priority) {
+  auto request = std::make_shared<LveAssetRequest>(type, filepath, nextSequence++, priority);
+
+  // loaded before, nothing to do
+  if (type == LveAssetRequest::Type::Model) {
+    request->model = registry.findModel(filepath);
+  } else {
+    request->texture = registry.findTexture(filepath);
+  }
+  if (request->model != nullptr || request->texture != nullptr) {
+    request->status = LveLoadStatus::Ready;
+    return request;
+  }
+
+  // already on its way, just make sure it is not less urgent than this request
+  std::string key = requestKey(type, filepath);
+  auto it = pending.find(key);
+  if (it != pending.end() && it->second->status.load() != LveLoadStatus::Cancelled) {
+    if (it->second->priority.load() < priority) {
+      it->second->priority = priority;
+    }
+    return it->second;
+  }
+
+  pending[key] = request;
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    queued.push_back(request);
+    activeJobs++;
+  }
+  // every job takes whichever request is most urgent when it starts, not necessarily this one
+  LveThreadPool::shared().submit([this]() { loadNext(); });
+  return request;
+}
+
+void LveAssetLoader::loadNext() {
+  std::shared_ptr<LveAssetRequest> request;
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto next = std::min_element(
+        queued.begin(),
+        queued.end(),
+        [](const std::shared_ptr<LveAssetRequest> &a, const std::shared_ptr<LveAssetRequest> &b) {
+          return isMoreUrgent(*a, *b);
+        });
+    request = std::move(*next);
+    *next = std::move(queued.back());
+    queued.pop_back();
+  }
+
+  LveLoadStatus expected = LveLoadStatus::Queued;
+  if (request->status.compare_exchange_strong(expected, LveLoadStatus::Loading)) {
+    try {
+      if (request->type == LveAssetRequest::Type::Model) {
+        request->builder = std::make_unique<LveModel::Builder>();
+        request->builder->loadModel(ENGINE_DIR + request->filepath);
+        request->uploadSize =
+            static_cast<size_t>(request->builder->getVertexStride()) *
+                request->builder->getVertexCount() +
+            static_cast<size_t>(request->builder->getIndexSize()) *
+                request->builder->getIndexCount();
+      } else {
+        request->imageData =
+            Texture::loadImage(
+                request->filepath, lveDevice.supportsBlockCompression(), &stagingPool);
+        request->uploadSize = request->imageData.getSize();
+      }
+      // a cancel that came in meanwhile wins
+      expected = LveLoadStatus::Loading;
+      request->status.compare_exchange_strong(expected, LveLoadStatus::Uploading);
+    } catch (const std::exception &e) {
+      request->error = e.what();
+      expected = LveLoadStatus::Loading;
+      request->status.compare_exchange_strong(expected, LveLoadStatus::Failed);
+    }
+  }
+
+  // notified under the lock, once activeJobs is 0 the destructor may destroy workerDone
+  std::lock_guard<std::mutex> lock{mutex};
+  completed.push_back(std::move(request));
+  activeJobs--;
+  workerDone.notify_all();
+}
+
+void LveAssetLoader::pump() {
+  LveUploadContext &uploadContext = registry.getUploadContext();
+  uploadContext.collect();
+
+  std::vector<std::shared_ptr<LveAssetRequest>> batch;
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    batch.swap(completed);
+  }
+
+  std::sort(
+      batch.begin(),
+      batch.end(),
+      [](const std::shared_ptr<LveAssetRequest> &a, const std::shared_ptr<LveAssetRequest> &b) {
+        return isMoreUrgent(*a, *b);
+      });
+
+  size_t uploaded = 0;
+  size_t processed = 0;
+  for (; processed < batch.size(); processed++) {
+    LveAssetRequest &request = *batch[processed];
+    LveLoadStatus status = request.status.load();
+    if (status == LveLoadStatus::Uploading) {
+      if (uploaded > 0 && uploaded + request.uploadSize > uploadBudget) break;
+      uploaded += request.uploadSize;
+      finalize(request);
+    } else {
+      if (status == LveLoadStatus::Failed) {
+        std::cerr << "failed to load " << request.filepath << ": " << request.error << std::endl;
+      }
+      // cancelled while loading, give the staging memory back
+      request.builder.reset();
+      request.imageData = {};
+    }
+
+    auto it = pending.find(requestKey(request.type, request.filepath));
+    if (it != pending.end() && it->second.get() == &request) {
+      pending.erase(it);
+    }
+  }
+
+  // over budget, the rest goes out next frame
+  if (processed < batch.size()) {
+    std::lock_guard<std::mutex> lock{mutex};
+    completed.insert(
+        completed.end(),
+        std::make_move_iterator(batch.begin() + processed),
+        std::make_move_iterator(batch.end()));
+  }
+
+  // everything finalized above goes to the gpu in one submission, later queue work sees it
+  uploadContext.submit();
+}
+
+void LveAssetLoader::finalize(LveAssetRequest &request) {
+  if (request.type == LveAssetRequest::Type::Model) {
+    auto model = std::make_shared<LveModel>(registry.getGeometryPool(), *request.builder);
+    request.model = registry.addModel(request.filepath, std::move(model));
+    request.builder.reset();
+  } else {
+    auto texture = std::make_shared<Texture>(
+        lveDevice, request.imageData, registry.getSamplerCache(), registry.getUploadContext());
+    request.texture = registry.addTexture(request.filepath, std::move(texture));
+    request.imageData = {};
+  }
+  request.status = LveLoadStatus::Ready;
+
+  auto callbacks = std::move(request.callbacks);
+  request.callbacks.clear();
+  for (auto &callback : callbacks) {
+    callback(request);
+  }
+}
+
+void LveAssetLoader::finishAll() {
+  size_t budget = uploadBudget;
+  uploadBudget = std::numeric_limits<size_t>::max();
+  // callbacks may request more assets, so keep going until nothing is left
+  while (!pending.empty()) {
+    {
+      std::unique_lock<std::mutex> lock{mutex};
+      workerDone.wait(lock, [this]() { return activeJobs == 0; });
+    }
+    pump();
+  }
+  uploadBudget = budget;
+}
+
+}  // namespace lve
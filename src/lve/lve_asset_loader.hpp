@@ -0,0 +1,191 @@
+#pragma once
+
+#include "lve_asset_registry.hpp"
+#include "lve_device.hpp"
+#include "lve_model.hpp"
+#include "lve_staging_pool.hpp"
+#include "lve_texture.hpp"
+
+// std
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+
+enum class LveLoadPriority : uint32_t { Low, Normal, High };
+
+enum class LveLoadStatus : uint32_t { Queued, Loading, Uploading, Ready, Failed, Cancelled };
+
+// shared state of one load, handles and the loader both point at it
+struct LveAssetRequest {
+  enum class Type { Model, Texture };
+
+  Type type;
+  std::string filepath;
+  uint64_t sequence;
+  std::atomic<LveLoadPriority> priority;
+  std::atomic<LveLoadStatus> status{LveLoadStatus::Queued};
+
+  // written by the worker, read by pump() once the status says so
+  std::unique_ptr<LveModel::Builder> builder;
+  Texture::ImageData imageData;
+  size_t uploadSize = 0;
+  std::string error;
+
+  // main thread only
+  std::shared_ptr<LveModel> model;
+  std::shared_ptr<Texture> texture;
+  std::vector<std::function<void(LveAssetRequest &)>> callbacks;
+
+  LveAssetRequest(Type type, std::string filepath, uint64_t sequence, LveLoadPriority priority)
+      : type{type}, filepath{std::move(filepath)}, sequence{sequence}, priority{priority} {}
+};
+
+/**
+ * Handle to an asset that is still streaming in. Copies share the same request, so cancelling or
+ * reprioritizing through one affects them all.
+ */
+template <typename T>
+class LveAssetHandle {
+  static_assert(
+      std::is_same_v<T, LveModel> || std::is_same_v<T, Texture>,
+      "Only models and textures are loaded asynchronously");
+
+ public:
+  LveAssetHandle() = default;
+
+  bool isValid() const { return request != nullptr; }
+  LveLoadStatus getStatus() const { return request->status.load(); }
+  bool isReady() const { return request != nullptr && getStatus() == LveLoadStatus::Ready; }
+  const std::string &getFilepath() const { return request->filepath; }
+  // only meaningful once the status is Failed
+  const std::string &getError() const { return request->error; }
+
+  // nullptr until the asset is ready, must be called on the thread that pumps the loader
+  std::shared_ptr<T> get() const {
+    if (!isReady()) return nullptr;
+    return asset(*request);
+  }
+
+  /**
+   * Calls callback with the asset once it is ready, right away if it already is. Runs on the thread
+   * that pumps the loader and never for failed or cancelled loads.
+   */
+  void then(std::function<void(const std::shared_ptr<T> &)> callback) const {
+    if (isReady()) {
+      callback(asset(*request));
+      return;
+    }
+    request->callbacks.push_back(
+        [callback = std::move(callback)](LveAssetRequest &r) { callback(asset(r)); });
+  }
+
+  // picked up the next time a worker looks for work, no effect once loading started
+  void setPriority(LveLoadPriority priority) const { request->priority = priority; }
+
+  // drops the load unless it already finished, the asset is never uploaded
+  void cancel() const {
+    LveLoadStatus status = request->status.load();
+    while (status != LveLoadStatus::Ready && status != LveLoadStatus::Failed &&
+           status != LveLoadStatus::Cancelled &&
+           !request->status.compare_exchange_weak(status, LveLoadStatus::Cancelled)) {
+    }
+  }
+
+ private:
+  friend class LveAssetLoader;
+
+  explicit LveAssetHandle(std::shared_ptr<LveAssetRequest> request)
+      : request{std::move(request)} {}
+
+  static std::shared_ptr<T> asset(LveAssetRequest &request) {
+    if constexpr (std::is_same_v<T, LveModel>) {
+      return request.model;
+    } else {
+      return request.texture;
+    }
+  }
+
+  std::shared_ptr<LveAssetRequest> request;
+};
+
+using LveModelHandle = LveAssetHandle<LveModel>;
+using LveTextureHandle = LveAssetHandle<Texture>;
+
+/**
+ * Streams models and textures in the background. Parsing, mesh processing and image decoding run
+ * on LveThreadPool::shared(), highest priority first, textures straight into a staging pool. The Vulkan side is created on the thread that
+ * calls pump(), once per frame, so nothing but the main thread ever touches the device queues.
+ * Finished assets are added to the registry, which also answers repeated requests right away.
+ */
+class LveAssetLoader {
+ public:
+  LveAssetLoader(LveDevice &device, LveAssetRegistry &registry);
+  // cancels everything still queued and waits for the workers to let go of the loader
+  ~LveAssetLoader();
+
+  LveAssetLoader(const LveAssetLoader &) = delete;
+  LveAssetLoader &operator=(const LveAssetLoader &) = delete;
+
+  // same path conventions as LveAssetRegistry
+  LveModelHandle loadModel(
+      const std::string &filepath, LveLoadPriority priority = LveLoadPriority::Normal);
+  LveTextureHandle loadTexture(
+      const std::string &filepath, LveLoadPriority priority = LveLoadPriority::Normal);
+
+  /**
+   * Uploads finished loads and runs their callbacks. Stops once uploadBudget bytes went to the GPU
+   * (at least one asset is always uploaded), so a burst of completions is spread over several
+   * frames instead of stalling one. All uploads of one call share a single submission and
+   * nothing waits for it.
+   */
+  void pump();
+  // blocks until every request made so far is ready, failed or cancelled
+  void finishAll();
+
+  void setUploadBudget(size_t bytesPerPump) { uploadBudget = bytesPerPump; }
+  size_t getPendingCount() const { return pending.size(); }
+
+  // 1x1 grey texture to show until the real one is in
+  std::shared_ptr<Texture> getPlaceholderTexture() const { return placeholderTexture; }
+  // drawn instead of a model that is still loading, nullptr (the default) skips the object
+  void setPlaceholderModel(std::shared_ptr<LveModel> model) { placeholderModel = std::move(model); }
+  std::shared_ptr<LveModel> getPlaceholderModel() const { return placeholderModel; }
+
+ private:
+  std::shared_ptr<LveAssetRequest> submitRequest(
+      LveAssetRequest::Type type, const std::string &filepath, LveLoadPriority priority);
+  // worker side: takes the most urgent queued request and does its cpu work
+  void loadNext();
+  void finalize(LveAssetRequest &request);
+
+  LveDevice &lveDevice;
+  LveAssetRegistry &registry;
+  // workers decode straight into it, must outlive every request's imageData
+  LveStagingPool stagingPool;
+  std::shared_ptr<Texture> placeholderTexture;
+  std::shared_ptr<LveModel> placeholderModel;
+  size_t uploadBudget = 32 * 1024 * 1024;
+  uint64_t nextSequence = 0;
+
+  // requests not yet finalized, by type and path so repeated requests share one load
+  std::unordered_map<std::string, std::shared_ptr<LveAssetRequest>> pending;
+
+  std::mutex mutex;
+  std::condition_variable workerDone;
+  // waiting for a worker, a short list so a scan beats keeping a heap valid under priority changes
+  std::vector<std::shared_ptr<LveAssetRequest>> queued;
+  // cpu work done, waiting for pump()
+  std::vector<std::shared_ptr<LveAssetRequest>> completed;
+  uint32_t activeJobs = 0;
+};
+
+}  // namespace lve
@@ -0,0 +1,263 @@
+#include "lve_asset_registry.hpp"
+
+#include "lve_mapped_file.hpp"
+#include "lve_utils.hpp"
+
+// std
+#include <filesystem>
+#include <system_error>
+#include <unordered_set>
+#include <vector>
+
+#ifndef ENGINE_DIR
+#define ENGINE_DIR "../"
+#endif
+
+namespace fs = std::filesystem;
+
+namespace lve {
+
+LveAssetRegistry::LveAssetRegistry(LveDevice &device)
+    : lveDevice{device},
+      samplerCache{device},
+      uploadContext{device},
+      geometryPool{device, uploadContext} {}
+
+LveAssetRegistry::~LveAssetRegistry() {
+  uploadContext.waitIdle();
+  // the owner waited for the device before destroying the registry
+  if (defragmentFrame != kNoDefragmentation) {
+    finishDefragmentation();
+  }
+}
+
+std::string LveAssetRegistry::canonicalPath(const std::string &path) {
+  std::error_code error;
+  fs::path canonical = fs::weakly_canonical(path, error);
+  if (error) {
+    return fs::path{path}.lexically_normal().string();
+  }
+  return canonical.string();
+}
+
+LveAssetRegistry::ContentKey LveAssetRegistry::hashContents(const std::string &path) {
+  LveMappedFile file{path};
+  return ContentKey{hashBytes(file.data(), file.size()), file.size()};
+}
+
+template <typename T, typename Load>
+std::shared_ptr<T> LveAssetRegistry::getAsset(
+    AssetTable<T> &table, const std::string &resolvedPath, Load load) {
+  std::string path = canonicalPath(resolvedPath);
+  auto it = table.byPath.find(path);
+  if (it != table.byPath.end()) {
+    return it->second;
+  }
+
+  if (!contentHashing) {
+    std::shared_ptr<T> asset = load();
+    table.byPath.emplace(path, asset);
+    return asset;
+  }
+
+  // a copy of an already loaded file under another name
+  ContentKey key = hashContents(path);
+  auto contentIt = table.byContent.find(key);
+  std::shared_ptr<T> asset = contentIt != table.byContent.end() ? contentIt->second : load();
+  table.byContent.emplace(key, asset);
+  table.byPath.emplace(path, asset);
+  return asset;
+}
+
+template <typename T>
+std::shared_ptr<T> LveAssetRegistry::findAsset(
+    AssetTable<T> &table, const std::string &resolvedPath) {
+  auto it = table.byPath.find(canonicalPath(resolvedPath));
+  return it != table.byPath.end() ? it->second : nullptr;
+}
+
+template <typename T>
+size_t LveAssetRegistry::releaseUnused(AssetTable<T> &table) {
+  // the content table shares ownership, only path entries count as separate users
+  std::unordered_map<const T *, long> registryRefs;
+  for (auto &kv : table.byPath) {
+    registryRefs[kv.second.get()]++;
+  }
+  for (auto &kv : table.byContent) {
+    registryRefs[kv.second.get()]++;
+  }
+
+  std::unordered_set<const T *> unused;
+  for (auto &kv : table.byPath) {
+    if (kv.second.use_count() == registryRefs[kv.second.get()]) {
+      unused.insert(kv.second.get());
+    }
+  }
+
+  for (auto it = table.byPath.begin(); it != table.byPath.end();) {
+    if (unused.count(it->second.get())) {
+      it = table.byPath.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = table.byContent.begin(); it != table.byContent.end();) {
+    if (unused.count(it->second.get())) {
+      it = table.byContent.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return unused.size();
+}
+
+std::shared_ptr<LveModel> LveAssetRegistry::getModel(const std::string &filepath) {
+  auto model = getAsset(models, ENGINE_DIR + filepath, [&]() -> std::shared_ptr<LveModel> {
+    return LveModel::createModelFromFile(geometryPool, filepath);
+  });
+  uploadContext.submit();
+  uploadContext.collect();
+  return model;
+}
+
+std::shared_ptr<Texture> LveAssetRegistry::getTexture(const std::string &filepath) {
+  auto texture = getAsset(textures, filepath, [&]() {
+    return std::make_shared<Texture>(
+        lveDevice,
+        Texture::loadImage(filepath, lveDevice.supportsBlockCompression()),
+        samplerCache,
+        uploadContext);
+  });
+  uploadContext.submit();
+  uploadContext.collect();
+  return texture;
+}
+
+std::shared_ptr<LveModel> LveAssetRegistry::findModel(const std::string &filepath) {
+  return findAsset(models, ENGINE_DIR + filepath);
+}
+
+std::shared_ptr<Texture> LveAssetRegistry::findTexture(const std::string &filepath) {
+  return findAsset(textures, filepath);
+}
+
+std::shared_ptr<LveModel> LveAssetRegistry::addModel(
+    const std::string &filepath, std::shared_ptr<LveModel> model) {
+  return getAsset(models, ENGINE_DIR + filepath, [&]() { return model; });
+}
+
+std::shared_ptr<Texture> LveAssetRegistry::addTexture(
+    const std::string &filepath, std::shared_ptr<Texture> texture) {
+  return getAsset(textures, filepath, [&]() { return texture; });
+}
+
+size_t LveAssetRegistry::releaseUnused() {
+  return releaseUnused(models) + releaseUnused(textures);
+}
+
+void LveAssetRegistry::beginFrame(int frameIndex) {
+  currentFrame = frameIndex;
+  geometryPool.beginFrame(frameIndex);
+  // the frame that recorded the copies completed, nothing reads the old copies anymore
+  if (defragmentFrame == frameIndex) {
+    finishDefragmentation();
+  }
+}
+
+void LveAssetRegistry::finishDefragmentation() {
+  for (auto &texture : relocatedTextures) {
+    texture->finishRelocation();
+  }
+  relocatedTextures.clear();
+  geometryPool.endDefragmentation();
+  lveDevice.getAllocator().endDefragmentation();
+  defragmentFrame = kNoDefragmentation;
+}
+
+VkDeviceSize LveAssetRegistry::getBlockFreeSize() const {
+  return geometryPool.getReservedSize() - geometryPool.getAllocatedSize() +
+         lveDevice.getAllocator().getBlockFreeSize();
+}
+
+bool LveAssetRegistry::shouldDefragment(VkDeviceSize minFreeBytes) {
+  if (defragmentFrame != kNoDefragmentation) return false;
+  // streaming is busy, and its uploads may write what a pass would move
+  uploadContext.collect();
+  if (!uploadContext.isIdle()) return false;
+  VkDeviceSize free = getBlockFreeSize();
+  return free >= minFreeBytes && free != stuckFreeSize;
+}
+
+VkDeviceSize LveAssetRegistry::defragment(VkCommandBuffer commandBuffer, VkDeviceSize moveBudget) {
+  uploadContext.collect();
+  if (defragmentFrame != kNoDefragmentation || !uploadContext.isIdle()) {
+    return 0;
+  }
+  LveAllocator &allocator = lveDevice.getAllocator();
+  geometryPool.beginDefragmentation();
+  // only registered textures get moved, blocks holding anything else stay where they are
+  std::vector<const LveAllocation *> movable;
+  for (auto &kv : textures.byPath) {
+    movable.push_back(&kv.second->getImageMemory());
+  }
+  allocator.beginDefragmentation(movable);
+
+  // the copies read what earlier frames wrote and overwrite what they read
+  VkMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+  vkCmdPipelineBarrier(
+      commandBuffer,
+      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0,
+      1,
+      &barrier,
+      0,
+      nullptr,
+      0,
+      nullptr);
+
+  // both tables hold an asset under its path, byContent only adds aliases
+  VkDeviceSize moved = 0;
+  for (auto &kv : models.byPath) {
+    if (moved >= moveBudget) break;
+    moved += kv.second->relocate(commandBuffer);
+  }
+  for (auto &kv : textures.byPath) {
+    if (moved >= moveBudget) break;
+    VkDeviceSize size = kv.second->relocate(commandBuffer);
+    if (size > 0) {
+      // kept alive until the old image can go
+      relocatedTextures.push_back(kv.second);
+      moved += size;
+    }
+  }
+
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+  vkCmdPipelineBarrier(
+      commandBuffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+      0,
+      1,
+      &barrier,
+      0,
+      nullptr,
+      0,
+      nullptr);
+
+  if (moved == 0) {
+    // nothing could move, no point in trying again before the free space changes
+    stuckFreeSize = getBlockFreeSize();
+    finishDefragmentation();
+    return 0;
+  }
+  stuckFreeSize = 0;
+  defragmentFrame = currentFrame;
+  return moved;
+}
+
+}  // namespace lve
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_geometry_pool.hpp"
+#include "lve_model.hpp"
+#include "lve_sampler_cache.hpp"
+#include "lve_texture.hpp"
+#include "lve_upload_context.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+
+/**
+ * Loads every model and texture once and hands out shared handles. Assets are keyed by their
+ * canonical path, and optionally by a hash of the file contents so copies under different names
+ * share one GPU resource as well. Textures created here share their samplers through one cache,
+ * models share one geometry pool, and both upload through one LveUploadContext.
+ */
+class LveAssetRegistry {
+ public:
+  explicit LveAssetRegistry(LveDevice &device);
+  // waits for uploads still in flight, the assets they write go away with the registry
+  ~LveAssetRegistry();
+
+  LveAssetRegistry(const LveAssetRegistry &) = delete;
+  LveAssetRegistry &operator=(const LveAssetRegistry &) = delete;
+
+  // same path convention as LveModel::createModelFromFile, the upload is submitted but not waited for
+  std::shared_ptr<LveModel> getModel(const std::string &filepath);
+  // same path convention as the Texture constructor, the upload is submitted but not waited for
+  std::shared_ptr<Texture> getTexture(const std::string &filepath);
+
+  // nullptr if nothing was registered under that path yet
+  std::shared_ptr<LveModel> findModel(const std::string &filepath);
+  std::shared_ptr<Texture> findTexture(const std::string &filepath);
+  /**
+   * Registers an asset that was loaded elsewhere, for example by LveAssetLoader. Returns the
+   * handle to use from now on, which is the already registered one if another load won the race.
+   */
+  std::shared_ptr<LveModel> addModel(const std::string &filepath, std::shared_ptr<LveModel> model);
+  std::shared_ptr<Texture> addTexture(const std::string &filepath, std::shared_ptr<Texture> texture);
+
+  /**
+   * Hashing reads every file in full on its first request, which defeats the point of the mesh
+   * cache for large models, so it is off by default.
+   */
+  void setContentHashing(bool enabled) { contentHashing = enabled; }
+
+  // drops assets nobody outside the registry holds anymore, returns how many were released
+  size_t releaseUnused();
+  /**
+   * Once per frame after the frame's fence has been waited for. Recycles freed geometry and
+   * finishes a defragmentation pass once the frame that recorded it completed.
+   */
+  void beginFrame(int frameIndex);
+  /**
+   * Whether a defragmentation pass is worth starting: none is in flight, streaming is idle and at
+   * least minFreeBytes lie unused inside geometry and device memory blocks. After a pass found
+   * nothing to move it stays false until that amount changes.
+   */
+  bool shouldDefragment(VkDeviceSize minFreeBytes);
+  /**
+   * Moves registered geometry and textures out of the emptiest geometry pool blocks and device
+   * memory blocks. The copies are recorded into commandBuffer, a frame's command buffer outside
+   * of any render pass, and draws recorded after them already use the new copies. Stops once
+   * moveBudget bytes were recorded, so a fragmented heap is compacted over several passes. The
+   * old copies are freed and emptied blocks released by beginFrame() once the frame completed,
+   * nothing waits for the GPU. Does nothing while uploads are pending. Returns the bytes moved.
+   */
+  VkDeviceSize defragment(VkCommandBuffer commandBuffer, VkDeviceSize moveBudget);
+
+  LveSamplerCache &getSamplerCache() { return samplerCache; }
+  LveUploadContext &getUploadContext() { return uploadContext; }
+  LveGeometryPool &getGeometryPool() { return geometryPool; }
+  size_t getModelCount() const { return models.size(); }
+  size_t getTextureCount() const { return textures.size(); }
+
+ private:
+  struct ContentKey {
+    uint64_t hash;
+    uint64_t size;
+
+    bool operator==(const ContentKey &other) const {
+      return hash == other.hash && size == other.size;
+    }
+  };
+  struct ContentKeyHash {
+    size_t operator()(const ContentKey &key) const { return static_cast<size_t>(key.hash); }
+  };
+
+  template <typename T>
+  struct AssetTable {
+    std::unordered_map<std::string, std::shared_ptr<T>> byPath;
+    std::unordered_map<ContentKey, std::shared_ptr<T>, ContentKeyHash> byContent;
+
+    size_t size() const { return byPath.size(); }
+  };
+
+  static std::string canonicalPath(const std::string &path);
+  static ContentKey hashContents(const std::string &path);
+
+  template <typename T, typename Load>
+  std::shared_ptr<T> getAsset(AssetTable<T> &table, const std::string &resolvedPath, Load load);
+  template <typename T>
+  static std::shared_ptr<T> findAsset(AssetTable<T> &table, const std::string &resolvedPath);
+  template <typename T>
+  static size_t releaseUnused(AssetTable<T> &table);
+  void finishDefragmentation();
+  VkDeviceSize getBlockFreeSize() const;
+
+  static constexpr int kNoDefragmentation = -1;
+
+  LveDevice &lveDevice;
+  LveSamplerCache samplerCache;
+  LveUploadContext uploadContext;
+  LveGeometryPool geometryPool;
+  bool contentHashing = false;
+
+  // note: declared after samplerCache, uploadContext and geometryPool so assets are destroyed before
+  // them
+  AssetTable<LveModel> models;
+  AssetTable<Texture> textures;
+
+  int currentFrame = 0;
+  // frame slot that recorded the pass in flight, if any
+  int defragmentFrame = kNoDefragmentation;
+  // their old images are destroyed when the pass finishes
+  std::vector<std::shared_ptr<Texture>> relocatedTextures;
+  // free block space when a pass last found nothing to move
+  VkDeviceSize stuckFreeSize = 0;
+};
+
+}  // namespace lve
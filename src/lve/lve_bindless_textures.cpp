@@ -0,0 +1,123 @@
+#include "lve_bindless_textures.hpp"
+
+#include "lve_texture.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+
+LveBindlessTextures::LveBindlessTextures(LveDevice &device, uint32_t capacity)
+    : lveDevice{device} {
+  assert(device.supportsBindlessTextures() && "Device lacks the descriptor indexing features");
+
+  // a combined image sampler counts against both the sampler and the sampled image limits
+  VkPhysicalDeviceDescriptorIndexingProperties indexingProperties{};
+  indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+  VkPhysicalDeviceProperties2 properties2{};
+  properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties2.pNext = &indexingProperties;
+  vkGetPhysicalDeviceProperties2(device.getPhysicalDevice(), &properties2);
+  this->capacity = std::min(
+      {capacity,
+       indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers,
+       indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+       indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+       indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages});
+
+  setLayout = LveDescriptorSetLayout::Builder(lveDevice)
+                  .addBinding(
+                      0,
+                      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                      VK_SHADER_STAGE_FRAGMENT_BIT,
+                      this->capacity)
+                  .setBindingFlags(
+                      0,
+                      VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                          VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                          VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT)
+                  .buildCached();
+  pool = LveDescriptorPool::Builder(lveDevice)
+             .setMaxSets(1)
+             .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, this->capacity)
+             .setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT)
+             .build();
+  if (!pool->allocateDescriptor(setLayout->getDescriptorSetLayout(), descriptorSet)) {
+    throw std::runtime_error("failed to allocate bindless texture descriptor set!");
+  }
+}
+
+LveBindlessTextures::~LveBindlessTextures() {
+  for (Texture *texture : textures) {
+    if (texture != nullptr) {
+      texture->bindlessTextures = nullptr;
+      texture->bindlessIndex = kNoTexture;
+    }
+  }
+}
+
+void LveBindlessTextures::beginFrame(int frameIndex) {
+  currentFrame = frameIndex;
+  auto done = std::partition(released.begin(), released.end(), [frameIndex](const Released &r) {
+    return r.frameIndex != frameIndex;
+  });
+  for (auto it = done; it != released.end(); ++it) {
+    freeIndices.push_back(it->index);
+  }
+  released.erase(done, released.end());
+}
+
+uint32_t LveBindlessTextures::getIndex(Texture &texture) {
+  if (texture.bindlessTextures == this) {
+    return texture.bindlessIndex;
+  }
+  assert(texture.bindlessTextures == nullptr && "Texture already belongs to another array");
+
+  uint32_t index;
+  if (!freeIndices.empty()) {
+    index = freeIndices.back();
+    freeIndices.pop_back();
+  } else if (textures.size() < capacity) {
+    index = static_cast<uint32_t>(textures.size());
+    textures.push_back(nullptr);
+  } else {
+    throw std::runtime_error("bindless texture array is full!");
+  }
+
+  textures[index] = &texture;
+  texture.bindlessTextures = this;
+  texture.bindlessIndex = index;
+  write(texture);
+  return index;
+}
+
+void LveBindlessTextures::update(Texture &texture) {
+  assert(texture.bindlessTextures == this && "Texture is not in this array");
+  // update after bind only allows writing elements no pending frame reads
+  release(texture);
+  getIndex(texture);
+}
+
+void LveBindlessTextures::release(Texture &texture) {
+  assert(texture.bindlessTextures == this && "Texture is not in this array");
+  // the stale element stays, partially bound arrays may hold descriptors nothing reads
+  textures[texture.bindlessIndex] = nullptr;
+  released.push_back({texture.bindlessIndex, currentFrame});
+  texture.bindlessTextures = nullptr;
+  texture.bindlessIndex = kNoTexture;
+}
+
+void LveBindlessTextures::write(Texture &texture) {
+  VkDescriptorImageInfo imageInfo{};
+  imageInfo.sampler = texture.getSampler();
+  imageInfo.imageView = texture.getImageView();
+  imageInfo.imageLayout = texture.getImageLayout();
+  VkDescriptorSet set = descriptorSet;
+  LveDescriptorWriter(*setLayout, *pool)
+      .writeImageElement(0, texture.bindlessIndex, &imageInfo)
+      .overwrite(set);
+}
+
+}  // namespace lve
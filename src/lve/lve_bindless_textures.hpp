@@ -0,0 +1,79 @@
+#pragma once
+
+#include "lve_descriptors.hpp"
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace lve {
+
+class Texture;
+
+/**
+ * Every texture in one descriptor set: a single COMBINED_IMAGE_SAMPLER array at binding 0 that is
+ * bound once per frame, shaders pick their texture by index. Needs
+ * LveDevice::supportsBindlessTextures(). The binding is partially bound and update after bind, so
+ * textures are written into it while frames in flight read other elements.
+ *
+ * A texture gets its index the first time it is asked for and keeps it until it is destroyed.
+ * Indices of destroyed textures are only handed out again once the frame slot they were released
+ * in comes around again. Either side may go first, the array detaches itself from the textures
+ * it still holds when it is destroyed.
+ */
+class LveBindlessTextures {
+ public:
+  // what objects without a texture pass to the shader
+  static constexpr uint32_t kNoTexture = ~0u;
+
+  // capacity is clamped to the device's update after bind limits
+  explicit LveBindlessTextures(LveDevice &device, uint32_t capacity = 4096);
+  ~LveBindlessTextures();
+
+  LveBindlessTextures(const LveBindlessTextures &) = delete;
+  LveBindlessTextures &operator=(const LveBindlessTextures &) = delete;
+
+  /**
+   * Recycles the indices released the last time frameIndex was recorded, call it once per frame
+   * before any getIndex(). The frame's fence has been waited for by then.
+   */
+  void beginFrame(int frameIndex);
+  // registers the texture on its first call, throws once the array is full
+  uint32_t getIndex(Texture &texture);
+  /**
+   * Moves the texture to a fresh element after its image view changed. Frames in flight may still
+   * read the old element, so it is recycled like a released one.
+   */
+  void update(Texture &texture);
+  // called by the texture's destructor
+  void release(Texture &texture);
+
+  LveDescriptorSetLayout &getSetLayout() { return *setLayout; }
+  VkDescriptorSet getDescriptorSet() const { return descriptorSet; }
+  uint32_t getCapacity() const { return capacity; }
+  uint32_t getTextureCount() const { return static_cast<uint32_t>(textures.size()); }
+
+ private:
+  struct Released {
+    uint32_t index;
+    int frameIndex;
+  };
+
+  void write(Texture &texture);
+
+  LveDevice &lveDevice;
+  uint32_t capacity;
+  std::shared_ptr<LveDescriptorSetLayout> setLayout;
+  std::unique_ptr<LveDescriptorPool> pool;
+  VkDescriptorSet descriptorSet;
+
+  // indexed like the array, nullptr for free elements
+  std::vector<Texture *> textures;
+  std::vector<uint32_t> freeIndices;
+  std::vector<Released> released;
+  int currentFrame = 0;
+};
+
+}  // namespace lve
@@ -0,0 +1,410 @@
+#include "lve_block_compression.hpp"
+
+#include "lve_thread_pool.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace lve {
+
+namespace {
+
+// 16 texels of a 4x4 block, row by row
+using Block = std::array<std::array<uint8_t, 4>, 16>;
+
+void loadBlock(
+    const uint8_t *rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY,
+    Block &block) {
+  for (uint32_t y = 0; y < 4; y++) {
+    uint32_t row = std::min(blockY * 4 + y, height - 1);
+    for (uint32_t x = 0; x < 4; x++) {
+      uint32_t column = std::min(blockX * 4 + x, width - 1);
+      std::memcpy(block[y * 4 + x].data(), rgba + (static_cast<size_t>(row) * width + column) * 4, 4);
+    }
+  }
+}
+
+/**
+ * Extremes of the block along its principal axis over the first channelCount channels. The axis
+ * comes from a few power iterations on the covariance, which is plenty for 16 points.
+ */
+void principalEndpoints(
+    const Block &block, int channelCount, std::array<float, 4> &low, std::array<float, 4> &high) {
+  std::array<float, 4> mean{};
+  for (const auto &texel : block) {
+    for (int c = 0; c < channelCount; c++) mean[c] += texel[c];
+  }
+  for (int c = 0; c < channelCount; c++) mean[c] /= 16.f;
+
+  float covariance[4][4]{};
+  for (const auto &texel : block) {
+    for (int i = 0; i < channelCount; i++) {
+      for (int j = 0; j < channelCount; j++) {
+        covariance[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+      }
+    }
+  }
+
+  // start from the covariance row of the widest channel, it cannot be orthogonal to the result
+  int widest = 0;
+  for (int c = 1; c < channelCount; c++) {
+    if (covariance[c][c] > covariance[widest][widest]) widest = c;
+  }
+  std::array<float, 4> axis{};
+  for (int c = 0; c < channelCount; c++) axis[c] = covariance[widest][c];
+  for (int iteration = 0; iteration < 8; iteration++) {
+    std::array<float, 4> next{};
+    float length = 0.f;
+    for (int i = 0; i < channelCount; i++) {
+      for (int j = 0; j < channelCount; j++) next[i] += covariance[i][j] * axis[j];
+      length = std::max(length, std::abs(next[i]));
+    }
+    // flat block, any axis will do
+    if (length < 1e-6f) break;
+    for (int i = 0; i < channelCount; i++) axis[i] = next[i] / length;
+  }
+
+  float minProjection = std::numeric_limits<float>::max();
+  float maxProjection = std::numeric_limits<float>::lowest();
+  for (const auto &texel : block) {
+    float projection = 0.f;
+    for (int c = 0; c < channelCount; c++) projection += (texel[c] - mean[c]) * axis[c];
+    minProjection = std::min(minProjection, projection);
+    maxProjection = std::max(maxProjection, projection);
+  }
+  float axisLength = 0.f;
+  for (int c = 0; c < channelCount; c++) axisLength += axis[c] * axis[c];
+  if (axisLength > 0.f) {
+    minProjection /= axisLength;
+    maxProjection /= axisLength;
+  }
+  for (int c = 0; c < channelCount; c++) {
+    low[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.f, 255.f);
+    high[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.f, 255.f);
+  }
+}
+
+// ---- BC1 ----
+
+uint16_t packRgb565(const std::array<float, 4> &color) {
+  auto r = static_cast<uint16_t>(std::lround(color[0] * 31.f / 255.f));
+  auto g = static_cast<uint16_t>(std::lround(color[1] * 63.f / 255.f));
+  auto b = static_cast<uint16_t>(std::lround(color[2] * 31.f / 255.f));
+  return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+std::array<int, 3> unpackRgb565(uint16_t packed) {
+  int r = (packed >> 11) & 31;
+  int g = (packed >> 5) & 63;
+  int b = packed & 31;
+  return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+}
+
+int colorDistance(const std::array<int, 3> &a, const uint8_t *b) {
+  int dr = a[0] - b[0], dg = a[1] - b[1], db = a[2] - b[2];
+  return dr * dr + dg * dg + db * db;
+}
+
+// picks the nearest of the four palette entries for every texel, returns the total error
+int bc1Indices(const Block &block, uint16_t color0, uint16_t color1, uint32_t &indices) {
+  std::array<std::array<int, 3>, 4> palette;
+  palette[0] = unpackRgb565(color0);
+  palette[1] = unpackRgb565(color1);
+  for (int c = 0; c < 3; c++) {
+    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+  }
+
+  int error = 0;
+  indices = 0;
+  for (int i = 0; i < 16; i++) {
+    int best = 0;
+    int bestError = colorDistance(palette[0], block[i].data());
+    for (int p = 1; p < 4; p++) {
+      int e = colorDistance(palette[p], block[i].data());
+      if (e < bestError) {
+        best = p;
+        bestError = e;
+      }
+    }
+    error += bestError;
+    indices |= static_cast<uint32_t>(best) << (2 * i);
+  }
+  return error;
+}
+
+// four color mode only, so the block also works as the color half of BC3
+void encodeBc1(const Block &block, uint8_t *out) {
+  std::array<float, 4> low, high;
+  principalEndpoints(block, 3, low, high);
+  uint16_t color0 = packRgb565(high);
+  uint16_t color1 = packRgb565(low);
+  if (color0 < color1) std::swap(color0, color1);
+
+  uint32_t indices = 0;
+  if (color0 != color1) {
+    int error = bc1Indices(block, color0, color1, indices);
+
+    // least squares refit of the endpoints to the chosen indices, kept if it is an improvement
+    static constexpr float kWeights[4] = {1.f, 0.f, 2.f / 3.f, 1.f / 3.f};
+    float aa = 0.f, bb = 0.f, ab = 0.f;
+    std::array<float, 4> ax{}, bx{};
+    for (int i = 0; i < 16; i++) {
+      float a = kWeights[(indices >> (2 * i)) & 3];
+      float b = 1.f - a;
+      aa += a * a;
+      bb += b * b;
+      ab += a * b;
+      for (int c = 0; c < 3; c++) {
+        ax[c] += a * block[i][c];
+        bx[c] += b * block[i][c];
+      }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) > 1e-6f) {
+      std::array<float, 4> refitHigh{}, refitLow{};
+      for (int c = 0; c < 3; c++) {
+        refitHigh[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.f, 255.f);
+        refitLow[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.f, 255.f);
+      }
+      uint16_t refit0 = packRgb565(refitHigh);
+      uint16_t refit1 = packRgb565(refitLow);
+      if (refit0 < refit1) std::swap(refit0, refit1);
+      uint32_t refitIndices;
+      if (refit0 != refit1 && bc1Indices(block, refit0, refit1, refitIndices) < error) {
+        color0 = refit0;
+        color1 = refit1;
+        indices = refitIndices;
+      }
+    }
+  }
+
+  out[0] = static_cast<uint8_t>(color0 & 0xff);
+  out[1] = static_cast<uint8_t>(color0 >> 8);
+  out[2] = static_cast<uint8_t>(color1 & 0xff);
+  out[3] = static_cast<uint8_t>(color1 >> 8);
+  std::memcpy(out + 4, &indices, 4);
+}
+
+// ---- BC4 ----
+
+// eight value mode: the two endpoints and six values between them
+void encodeBc4(const Block &block, int channel, uint8_t *out) {
+  int low = 255, high = 0;
+  for (const auto &texel : block) {
+    low = std::min<int>(low, texel[channel]);
+    high = std::max<int>(high, texel[channel]);
+  }
+
+  std::array<int, 8> palette;
+  palette[0] = high;
+  palette[1] = low;
+  for (int i = 1; i < 7; i++) {
+    palette[i + 1] = ((7 - i) * high + i * low) / 7;
+  }
+
+  uint64_t indices = 0;
+  if (high != low) {
+    for (int i = 0; i < 16; i++) {
+      int value = block[i][channel];
+      int best = 0;
+      for (int p = 1; p < 8; p++) {
+        if (std::abs(palette[p] - value) < std::abs(palette[best] - value)) best = p;
+      }
+      indices |= static_cast<uint64_t>(best) << (3 * i);
+    }
+  }
+
+  out[0] = static_cast<uint8_t>(high);
+  out[1] = static_cast<uint8_t>(low);
+  for (int i = 0; i < 6; i++) {
+    out[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+  }
+}
+
+// ---- BC7 ----
+
+class BitWriter {
+ public:
+  explicit BitWriter(uint8_t *out) : out{out} { std::memset(out, 0, 16); }
+
+  void write(uint32_t value, int bitCount) {
+    for (int i = 0; i < bitCount; i++, position++) {
+      if (value & (1u << i)) out[position / 8] |= static_cast<uint8_t>(1u << (position % 8));
+    }
+  }
+
+ private:
+  uint8_t *out;
+  int position = 0;
+};
+
+/**
+ * Mode 6 only: one subset, rgba endpoints with 7 bits plus a shared p-bit each and 4 bit indices.
+ * The other modes mostly win on blocks with several distinct colors, which a single line through
+ * rgba still handles at a quality well above BC1 and BC3.
+ */
+void encodeBc7(const Block &block, uint8_t *out) {
+  static constexpr int kWeights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+  std::array<float, 4> low, high;
+  principalEndpoints(block, 4, low, high);
+
+  // 7 bit endpoints, the p-bit that brings all four channels closest becomes their lowest bit
+  std::array<std::array<int, 4>, 2> endpoints;
+  std::array<int, 2> pBits;
+  const std::array<float, 4> *targets[2] = {&low, &high};
+  for (int e = 0; e < 2; e++) {
+    float bestError = std::numeric_limits<float>::max();
+    for (int p = 0; p < 2; p++) {
+      std::array<int, 4> quantized;
+      float error = 0.f;
+      for (int c = 0; c < 4; c++) {
+        int q = std::clamp(static_cast<int>(std::lround(((*targets[e])[c] - p) / 2.f)), 0, 127);
+        quantized[c] = q;
+        float d = static_cast<float>((q << 1) | p) - (*targets[e])[c];
+        error += d * d;
+      }
+      if (error < bestError) {
+        bestError = error;
+        endpoints[e] = quantized;
+        pBits[e] = p;
+      }
+    }
+  }
+
+  std::array<std::array<int, 4>, 16> palette;
+  for (int i = 0; i < 16; i++) {
+    for (int c = 0; c < 4; c++) {
+      int e0 = (endpoints[0][c] << 1) | pBits[0];
+      int e1 = (endpoints[1][c] << 1) | pBits[1];
+      palette[i][c] = ((64 - kWeights[i]) * e0 + kWeights[i] * e1 + 32) >> 6;
+    }
+  }
+
+  std::array<int, 16> indices;
+  for (int i = 0; i < 16; i++) {
+    int bestError = std::numeric_limits<int>::max();
+    for (int p = 0; p < 16; p++) {
+      int error = 0;
+      for (int c = 0; c < 4; c++) {
+        int d = palette[p][c] - block[i][c];
+        error += d * d;
+      }
+      if (error < bestError) {
+        bestError = error;
+        indices[i] = p;
+      }
+    }
+  }
+
+  // the first index is stored with its top bit implied zero, flip the line if it is set
+  if (indices[0] & 8) {
+    std::swap(endpoints[0], endpoints[1]);
+    std::swap(pBits[0], pBits[1]);
+    for (int &index : indices) index = 15 - index;
+  }
+
+  BitWriter writer{out};
+  writer.write(1u << 6, 7);
+  for (int c = 0; c < 4; c++) {
+    writer.write(static_cast<uint32_t>(endpoints[0][c]), 7);
+    writer.write(static_cast<uint32_t>(endpoints[1][c]), 7);
+  }
+  writer.write(static_cast<uint32_t>(pBits[0]), 1);
+  writer.write(static_cast<uint32_t>(pBits[1]), 1);
+  writer.write(static_cast<uint32_t>(indices[0]), 3);
+  for (int i = 1; i < 16; i++) {
+    writer.write(static_cast<uint32_t>(indices[i]), 4);
+  }
+}
+
+void encodeBlock(LveBlockFormat format, const Block &block, uint8_t *out) {
+  switch (format) {
+    case LveBlockFormat::BC1:
+      encodeBc1(block, out);
+      break;
+    case LveBlockFormat::BC3:
+      encodeBc4(block, 3, out);
+      encodeBc1(block, out + 8);
+      break;
+    case LveBlockFormat::BC4:
+      encodeBc4(block, 0, out);
+      break;
+    case LveBlockFormat::BC5:
+      encodeBc4(block, 0, out);
+      encodeBc4(block, 1, out + 8);
+      break;
+    case LveBlockFormat::BC7:
+      encodeBc7(block, out);
+      break;
+  }
+}
+
+}  // namespace
+
+uint32_t getBlockBytes(LveBlockFormat format) {
+  return format == LveBlockFormat::BC1 || format == LveBlockFormat::BC4 ? 8 : 16;
+}
+
+VkFormat getBlockVkFormat(LveBlockFormat format, bool srgb) {
+  switch (format) {
+    case LveBlockFormat::BC1:
+      return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    case LveBlockFormat::BC3:
+      return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+    case LveBlockFormat::BC4:
+      return VK_FORMAT_BC4_UNORM_BLOCK;
+    case LveBlockFormat::BC5:
+      return VK_FORMAT_BC5_UNORM_BLOCK;
+    case LveBlockFormat::BC7:
+      return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+  }
+  return VK_FORMAT_UNDEFINED;
+}
+
+bool isBlockCompressed(VkFormat format) {
+  return format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+}
+
+size_t getImageLevelSize(VkFormat format, uint32_t width, uint32_t height) {
+  size_t blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+  switch (format) {
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_R8G8B8A8_UNORM:
+      return static_cast<size_t>(width) * height * 4;
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+      return blocks * 8;
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+      return blocks * 16;
+    default:
+      return 0;
+  }
+}
+
+void compressImage(
+    LveBlockFormat format, const uint8_t *rgba, uint32_t width, uint32_t height, uint8_t *blocks) {
+  const uint32_t blocksX = (width + 3) / 4;
+  const uint32_t blocksY = (height + 3) / 4;
+  const uint32_t blockBytes = getBlockBytes(format);
+  LveThreadPool::shared().parallelFor(blocksY, [&](size_t blockY) {
+    Block block;
+    uint8_t *out = blocks + blockY * blocksX * blockBytes;
+    for (uint32_t blockX = 0; blockX < blocksX; blockX++, out += blockBytes) {
+      loadBlock(rgba, width, height, blockX, static_cast<uint32_t>(blockY), block);
+      encodeBlock(format, block, out);
+    }
+  });
+}
+
+}  // namespace lve
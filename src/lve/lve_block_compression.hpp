@@ -0,0 +1,40 @@
+#pragma once
+
+// libs
+#include <vulkan/vulkan_core.h>
+
+// std
+#include <cstddef>
+#include <cstdint>
+
+namespace lve {
+
+/**
+ * Block compressed texture formats the CPU encoder can produce. All of them store 4x4 texel blocks,
+ * BC1 and BC4 in 8 bytes, the others in 16.
+ */
+enum class LveBlockFormat : uint32_t {
+  BC1,  // rgb, opaque
+  BC3,  // rgb + smooth alpha
+  BC4,  // one linear channel
+  BC5,  // two linear channels, e.g. the xy of a normal map
+  BC7,  // rgba, best quality at the size of BC3
+};
+
+uint32_t getBlockBytes(LveBlockFormat format);
+// BC4 and BC5 only exist as unorm/snorm, srgb is ignored for them
+VkFormat getBlockVkFormat(LveBlockFormat format, bool srgb);
+bool isBlockCompressed(VkFormat format);
+
+// bytes of one width x height level in format, 0 for formats textures cannot be stored in
+size_t getImageLevelSize(VkFormat format, uint32_t width, uint32_t height);
+
+/**
+ * Encodes width x height rgba8 pixels into blocks. Rows of blocks are spread over
+ * LveThreadPool::shared(), so this may be called from a pool job. Partial blocks at the right and
+ * bottom edge repeat the last column and row.
+ */
+void compressImage(
+    LveBlockFormat format, const uint8_t *rgba, uint32_t width, uint32_t height, uint8_t *blocks);
+
+}  // namespace lve
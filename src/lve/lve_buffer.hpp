@@ -46,7 +46,7 @@ class LveBuffer {
   LveDevice& lveDevice;
   void* mapped = nullptr;
   VkBuffer buffer = VK_NULL_HANDLE;
-  VkDeviceMemory memory = VK_NULL_HANDLE;
+  LveAllocation memory;
 
   VkDeviceSize bufferSize;
   uint32_t instanceCount;
@@ -0,0 +1,98 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace lve {
+
+/**
+ * Flat open addressing set used to weld identical values (mesh vertices) into an index buffer.
+ * Values are appended to the caller's vector and only their indices live in the table, together
+ * with a hash fragment so most mismatching probes never touch the value itself.
+ *
+ * Keys are compared bitwise, so T must not contain padding. Unlike operator== this keeps
+ * 0.0 and -0.0 apart, which only costs a duplicate vertex.
+ */
+template <typename T>
+class LveDedupTable {
+  static_assert(std::is_trivially_copyable<T>::value, "LveDedupTable needs trivially copyable T");
+  static_assert(sizeof(T) % sizeof(uint32_t) == 0, "LveDedupTable hashes T as 32 bit words");
+
+ public:
+  /**
+   * @param values Receives every distinct value in insertion order
+   * @param expectedCount Upper bound of insert() calls, sizes the table so it never has to grow
+   * for typical meshes
+   */
+  LveDedupTable(std::vector<T> &values, size_t expectedCount) : values{values} {
+    size_t capacity = 16;
+    // expectedCount is the corner count, the number of distinct vertices is usually far lower so
+    // this stays well below the 3/4 load limit without doubling the memory for every mesh
+    while (capacity < expectedCount + expectedCount / 4) capacity <<= 1;
+    slots.assign(capacity, Slot{0, kEmpty});
+    mask = capacity - 1;
+  }
+
+  /**
+   * Returns the index of value in values, appending it first if it was not seen before. One probe
+   * sequence both finds existing values and claims the slot for new ones.
+   */
+  uint32_t insert(const T &value) {
+    uint32_t hash = hashValue(value);
+    size_t slot = hash & mask;
+    while (true) {
+      Slot &entry = slots[slot];
+      if (entry.index == kEmpty) {
+        uint32_t index = static_cast<uint32_t>(values.size());
+        entry = {hash, index};
+        values.push_back(value);
+        if (values.size() * 4 > slots.size() * 3) grow();
+        return index;
+      }
+      if (entry.hash == hash && std::memcmp(&values[entry.index], &value, sizeof(T)) == 0) {
+        return entry.index;
+      }
+      slot = (slot + 1) & mask;
+    }
+  }
+
+ private:
+  static constexpr uint32_t kEmpty = ~0u;
+
+  struct Slot {
+    uint32_t hash;
+    uint32_t index;
+  };
+
+  static uint32_t hashValue(const T &value) {
+    uint32_t words[sizeof(T) / sizeof(uint32_t)];
+    std::memcpy(words, &value, sizeof(T));
+    uint64_t hash = 0x9e3779b97f4a7c15ull;
+    for (uint32_t word : words) {
+      hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+      hash ^= hash >> 32;
+    }
+    return static_cast<uint32_t>(hash);
+  }
+
+  void grow() {
+    std::vector<Slot> old = std::move(slots);
+    slots.assign(old.size() * 2, Slot{0, kEmpty});
+    mask = slots.size() - 1;
+    for (const Slot &entry : old) {
+      if (entry.index == kEmpty) continue;
+      size_t slot = entry.hash & mask;
+      while (slots[slot].index != kEmpty) slot = (slot + 1) & mask;
+      slots[slot] = entry;
+    }
+  }
+
+  std::vector<T> &values;
+  std::vector<Slot> slots;
+  size_t mask;
+};
+
+}  // namespace lve
@@ -0,0 +1,51 @@
+#include "lve_descriptor_layout_cache.hpp"
+
+#include "lve_utils.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+
+namespace lve {
+
+LveDescriptorSetLayoutCache::LveDescriptorSetLayoutCache(LveDevice &device) : lveDevice{device} {}
+
+size_t LveDescriptorSetLayoutCache::LayoutKeyHash::operator()(const LayoutKey &key) const {
+  return static_cast<size_t>(hashBytes(key.fields.data(), key.fields.size() * sizeof(uint32_t)));
+}
+
+std::shared_ptr<LveDescriptorSetLayout> LveDescriptorSetLayoutCache::getLayout(
+    const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> &bindings,
+    const std::unordered_map<uint32_t, VkDescriptorBindingFlags> &bindingFlags) {
+  // the maps iterate in no particular order, the key does
+  std::vector<uint32_t> bindingNumbers;
+  for (const auto &kv : bindings) {
+    bindingNumbers.push_back(kv.first);
+  }
+  std::sort(bindingNumbers.begin(), bindingNumbers.end());
+
+  LayoutKey key;
+  key.fields.reserve(bindingNumbers.size() * 5);
+  for (uint32_t binding : bindingNumbers) {
+    const VkDescriptorSetLayoutBinding &layoutBinding = bindings.at(binding);
+    assert(layoutBinding.pImmutableSamplers == nullptr && "Immutable samplers are not cached");
+    auto flags = bindingFlags.find(binding);
+    key.fields.insert(
+        key.fields.end(),
+        {binding,
+         static_cast<uint32_t>(layoutBinding.descriptorType),
+         layoutBinding.descriptorCount,
+         layoutBinding.stageFlags,
+         flags != bindingFlags.end() ? flags->second : 0});
+  }
+
+  auto it = layouts.find(key);
+  if (it != layouts.end()) {
+    return it->second;
+  }
+  auto layout = std::make_shared<LveDescriptorSetLayout>(lveDevice, bindings, bindingFlags);
+  layouts.emplace(std::move(key), layout);
+  return layout;
+}
+
+}  // namespace lve
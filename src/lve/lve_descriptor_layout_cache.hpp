@@ -0,0 +1,46 @@
+#pragma once
+
+#include "lve_descriptors.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+
+/**
+ * Hands out one LveDescriptorSetLayout per distinct list of bindings, so render systems asking
+ * for the same layout share a single VkDescriptorSetLayout (and its update template). Owned by
+ * LveDevice, see LveDescriptorSetLayout::Builder::buildCached().
+ */
+class LveDescriptorSetLayoutCache {
+ public:
+  explicit LveDescriptorSetLayoutCache(LveDevice &device);
+
+  LveDescriptorSetLayoutCache(const LveDescriptorSetLayoutCache &) = delete;
+  LveDescriptorSetLayoutCache &operator=(const LveDescriptorSetLayoutCache &) = delete;
+
+  // bindings must not use immutable samplers
+  std::shared_ptr<LveDescriptorSetLayout> getLayout(
+      const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> &bindings,
+      const std::unordered_map<uint32_t, VkDescriptorBindingFlags> &bindingFlags);
+  size_t getLayoutCount() const { return layouts.size(); }
+
+ private:
+  // binding, type, count, stages and flags of every binding, ordered by binding number
+  struct LayoutKey {
+    std::vector<uint32_t> fields;
+
+    bool operator==(const LayoutKey &other) const { return fields == other.fields; }
+  };
+  struct LayoutKeyHash {
+    size_t operator()(const LayoutKey &key) const;
+  };
+
+  LveDevice &lveDevice;
+  std::unordered_map<LayoutKey, std::shared_ptr<LveDescriptorSetLayout>, LayoutKeyHash> layouts;
+};
+
+}  // namespace lve
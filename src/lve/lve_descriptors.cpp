@@ -1,6 +1,9 @@
 #include "lve_descriptors.hpp"
 
+#include "lve_descriptor_layout_cache.hpp"
+
 // std
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 
@@ -23,18 +26,41 @@ LveDescriptorSetLayout::Builder &LveDescriptorSetLayout::Builder::addBinding(
   return *this;
 }
 
+LveDescriptorSetLayout::Builder &LveDescriptorSetLayout::Builder::setBindingFlags(
+    uint32_t binding, VkDescriptorBindingFlags flags) {
+  assert(bindings.count(binding) == 1 && "Binding flags set before the binding was added");
+  bindingFlags[binding] = flags;
+  return *this;
+}
+
 std::unique_ptr<LveDescriptorSetLayout> LveDescriptorSetLayout::Builder::build() const {
-  return std::make_unique<LveDescriptorSetLayout>(lveDevice, bindings);
+  return std::make_unique<LveDescriptorSetLayout>(lveDevice, bindings, bindingFlags);
+}
+
+std::shared_ptr<LveDescriptorSetLayout> LveDescriptorSetLayout::Builder::buildCached() const {
+  return lveDevice.getDescriptorSetLayoutCache().getLayout(bindings, bindingFlags);
 }
 
 // *************** Descriptor Set Layout *********************
 
 LveDescriptorSetLayout::LveDescriptorSetLayout(
-    LveDevice &lveDevice, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings)
+    LveDevice &lveDevice,
+    std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+    const std::unordered_map<uint32_t, VkDescriptorBindingFlags> &bindingFlags)
     : lveDevice{lveDevice}, bindings{bindings} {
   std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
+  // parallel to setLayoutBindings
+  std::vector<VkDescriptorBindingFlags> setLayoutBindingFlags{};
+  bool updateAfterBind = false;
   for (auto kv : bindings) {
     setLayoutBindings.push_back(kv.second);
+    VkDescriptorBindingFlags flags = 0;
+    auto it = bindingFlags.find(kv.first);
+    if (it != bindingFlags.end()) {
+      flags = it->second;
+    }
+    setLayoutBindingFlags.push_back(flags);
+    updateAfterBind = updateAfterBind || (flags & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT);
   }
 
   VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo{};
@@ -42,6 +68,17 @@ LveDescriptorSetLayout::LveDescriptorSetLayout(
   descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
   descriptorSetLayoutInfo.pBindings = setLayoutBindings.data();
 
+  VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+  bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+  if (!bindingFlags.empty()) {
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(setLayoutBindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = setLayoutBindingFlags.data();
+    descriptorSetLayoutInfo.pNext = &bindingFlagsInfo;
+  }
+  if (updateAfterBind) {
+    descriptorSetLayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+  }
+
   if (vkCreateDescriptorSetLayout(
           lveDevice.device(),
           &descriptorSetLayoutInfo,
@@ -52,9 +89,105 @@ LveDescriptorSetLayout::LveDescriptorSetLayout(
 }
 
 LveDescriptorSetLayout::~LveDescriptorSetLayout() {
+  if (updateTemplate != VK_NULL_HANDLE) {
+    vkDestroyDescriptorUpdateTemplate(lveDevice.device(), updateTemplate, nullptr);
+  }
   vkDestroyDescriptorSetLayout(lveDevice.device(), descriptorSetLayout, nullptr);
 }
 
+std::vector<uint32_t> LveDescriptorSetLayout::getSortedBindings() const {
+  std::vector<uint32_t> bindingNumbers;
+  for (const auto &kv : bindings) {
+    bindingNumbers.push_back(kv.first);
+  }
+  std::sort(bindingNumbers.begin(), bindingNumbers.end());
+  return bindingNumbers;
+}
+
+void LveDescriptorSetLayout::createUpdateTemplate() {
+  std::vector<uint32_t> bindingNumbers = getSortedBindings();
+
+  // infos[i] feeds the i-th binding
+  std::vector<VkDescriptorUpdateTemplateEntry> entries;
+  for (size_t i = 0; i < bindingNumbers.size(); i++) {
+    const VkDescriptorSetLayoutBinding &layoutBinding = bindings[bindingNumbers[i]];
+    assert(
+        layoutBinding.descriptorCount == 1 &&
+        "Update templates only cover bindings of a single descriptor");
+    VkDescriptorUpdateTemplateEntry entry{};
+    entry.dstBinding = layoutBinding.binding;
+    entry.dstArrayElement = 0;
+    entry.descriptorCount = 1;
+    entry.descriptorType = layoutBinding.descriptorType;
+    entry.offset = i * sizeof(LveDescriptorInfo);
+    entry.stride = sizeof(LveDescriptorInfo);
+    entries.push_back(entry);
+  }
+
+  VkDescriptorUpdateTemplateCreateInfo templateInfo{};
+  templateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+  templateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+  templateInfo.pDescriptorUpdateEntries = entries.data();
+  templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+  templateInfo.descriptorSetLayout = descriptorSetLayout;
+
+  if (vkCreateDescriptorUpdateTemplate(
+          lveDevice.device(),
+          &templateInfo,
+          nullptr,
+          &updateTemplate) != VK_SUCCESS) {
+    throw std::runtime_error("failed to create descriptor update template!");
+  }
+}
+
+void LveDescriptorSetLayout::writeDescriptors(
+    VkDescriptorSet set, const LveDescriptorInfo *infos) const {
+  std::vector<uint32_t> bindingNumbers = getSortedBindings();
+  std::vector<VkWriteDescriptorSet> writes(bindingNumbers.size());
+  for (size_t i = 0; i < bindingNumbers.size(); i++) {
+    const VkDescriptorSetLayoutBinding &layoutBinding = bindings.at(bindingNumbers[i]);
+    assert(
+        layoutBinding.descriptorCount == 1 &&
+        "Descriptor updates only cover bindings of a single descriptor");
+    VkWriteDescriptorSet &write = writes[i];
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = set;
+    write.dstBinding = layoutBinding.binding;
+    write.dstArrayElement = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = layoutBinding.descriptorType;
+    switch (layoutBinding.descriptorType) {
+      case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+      case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+      case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+      case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+        write.pBufferInfo = &infos[i].buffer;
+        break;
+      default:
+        write.pImageInfo = &infos[i].image;
+        break;
+    }
+  }
+  vkUpdateDescriptorSets(
+      lveDevice.device(),
+      static_cast<uint32_t>(writes.size()),
+      writes.data(),
+      0,
+      nullptr);
+}
+
+void LveDescriptorSetLayout::update(VkDescriptorSet set, const LveDescriptorInfo *infos) {
+  // core since 1.1, the fallback is what LveDescriptorWriter would do
+  if (lveDevice.getApiVersion() < VK_API_VERSION_1_1) {
+    writeDescriptors(set, infos);
+    return;
+  }
+  if (updateTemplate == VK_NULL_HANDLE) {
+    createUpdateTemplate();
+  }
+  vkUpdateDescriptorSetWithTemplate(lveDevice.device(), set, updateTemplate, infos);
+}
+
 // *************** Descriptor Pool Builder *********************
 
 LveDescriptorPool::Builder &LveDescriptorPool::Builder::addPoolSize(
@@ -177,6 +310,28 @@ LveDescriptorWriter &LveDescriptorWriter::writeImage(
   return *this;
 }
 
+LveDescriptorWriter &LveDescriptorWriter::writeImageElement(
+    uint32_t binding, uint32_t arrayElement, VkDescriptorImageInfo *imageInfo) {
+  assert(setLayout.bindings.count(binding) == 1 && "Layout does not contain specified binding");
+
+  auto &bindingDescription = setLayout.bindings[binding];
+
+  assert(
+      arrayElement < bindingDescription.descriptorCount &&
+      "Array element out of range for the binding");
+
+  VkWriteDescriptorSet write{};
+  write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  write.descriptorType = bindingDescription.descriptorType;
+  write.dstBinding = binding;
+  write.dstArrayElement = arrayElement;
+  write.pImageInfo = imageInfo;
+  write.descriptorCount = 1;
+
+  writes.push_back(write);
+  return *this;
+}
+
 bool LveDescriptorWriter::build(VkDescriptorSet &set) {
   bool success = pool.allocateDescriptor(setLayout.getDescriptorSetLayout(), set);
   if (!success) {
@@ -190,7 +345,7 @@ void LveDescriptorWriter::overwrite(VkDescriptorSet &set) {
   for (auto &write : writes) {
     write.dstSet = set;
   }
-  vkUpdateDescriptorSets(pool.lveDevice.device(), writes.size(), writes.data(), 0, nullptr);
+  vkUpdateDescriptorSets(setLayout.lveDevice.device(), writes.size(), writes.data(), 0, nullptr);
 }
 
 }  // namespace lve
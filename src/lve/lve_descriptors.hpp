@@ -9,6 +9,12 @@
 
 namespace lve {
 
+// one descriptor for LveDescriptorSetLayout::update, which member is read follows the binding type
+union LveDescriptorInfo {
+  VkDescriptorBufferInfo buffer;
+  VkDescriptorImageInfo image;
+};
+
 class LveDescriptorSetLayout {
  public:
   class Builder {
@@ -20,24 +26,45 @@ class LveDescriptorSetLayout {
         VkDescriptorType descriptorType,
         VkShaderStageFlags stageFlags,
         uint32_t count = 1);
+    // descriptor indexing flags of an added binding, UPDATE_AFTER_BIND makes the layout need an
+    // UPDATE_AFTER_BIND pool
+    Builder &setBindingFlags(uint32_t binding, VkDescriptorBindingFlags flags);
     std::unique_ptr<LveDescriptorSetLayout> build() const;
+    // the device's shared layout for these bindings, created on first request
+    std::shared_ptr<LveDescriptorSetLayout> buildCached() const;
 
    private:
     LveDevice &lveDevice;
     std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings{};
+    std::unordered_map<uint32_t, VkDescriptorBindingFlags> bindingFlags{};
   };
 
   LveDescriptorSetLayout(
-      LveDevice &lveDevice, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings);
+      LveDevice &lveDevice,
+      std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+      const std::unordered_map<uint32_t, VkDescriptorBindingFlags> &bindingFlags = {});
   ~LveDescriptorSetLayout();
   LveDescriptorSetLayout(const LveDescriptorSetLayout &) = delete;
   LveDescriptorSetLayout &operator=(const LveDescriptorSetLayout &) = delete;
 
   VkDescriptorSetLayout getDescriptorSetLayout() const { return descriptorSetLayout; }
 
+  /**
+   * Writes every binding of set with one vkUpdateDescriptorSetWithTemplate, infos holds one entry
+   * per binding in ascending binding order. Cheaper than LveDescriptorWriter for sets written
+   * often. Only for layouts whose bindings are single descriptors, the template is created on
+   * first use. Devices below Vulkan 1.1 have no templates and get the same writes one by one.
+   */
+  void update(VkDescriptorSet set, const LveDescriptorInfo *infos);
+
  private:
+  std::vector<uint32_t> getSortedBindings() const;
+  void createUpdateTemplate();
+  void writeDescriptors(VkDescriptorSet set, const LveDescriptorInfo *infos) const;
+
   LveDevice &lveDevice;
   VkDescriptorSetLayout descriptorSetLayout;
+  VkDescriptorUpdateTemplate updateTemplate = VK_NULL_HANDLE;
   std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings;
 
   friend class LveDescriptorWriter;
@@ -90,6 +117,9 @@ class LveDescriptorWriter {
 
   LveDescriptorWriter &writeBuffer(uint32_t binding, VkDescriptorBufferInfo *bufferInfo);
   LveDescriptorWriter &writeImage(uint32_t binding, VkDescriptorImageInfo *imageInfo);
+  // one element of an array binding, the others keep what they hold
+  LveDescriptorWriter &writeImageElement(
+      uint32_t binding, uint32_t arrayElement, VkDescriptorImageInfo *imageInfo);
 
   bool build(VkDescriptorSet &set);
   void overwrite(VkDescriptorSet &set);
@@ -1,13 +1,17 @@
 #pragma once
 
+#include "lve_allocator.hpp"
 #include "lve_window.hpp"
 
 // std lib headers
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace lve {
 
+class LveDescriptorSetLayoutCache;
+
 struct SwapChainSupportDetails {
   VkSurfaceCapabilitiesKHR capabilities;
   std::vector<VkSurfaceFormatKHR> formats;
@@ -17,9 +21,12 @@ struct SwapChainSupportDetails {
 struct QueueFamilyIndices {
   uint32_t graphicsFamily;
   uint32_t presentFamily;
+  // a transfer only family if the device has one (DMA engine), the graphics family otherwise
+  uint32_t transferFamily;
   bool graphicsFamilyHasValue = false;
   bool presentFamilyHasValue = false;
   bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
+  bool hasDedicatedTransfer() const { return transferFamily != graphicsFamily; }
 };
 
 class LveDevice {
@@ -45,6 +52,22 @@ class LveDevice {
   VkSurfaceKHR surface() { return surface_; }
   VkQueue graphicsQueue() { return graphicsQueue_; }
   VkQueue presentQueue() { return presentQueue_; }
+  // same as graphicsQueue() unless hasDedicatedTransferQueue()
+  VkQueue transferQueue() { return transferQueue_; }
+  VkCommandPool getTransferCommandPool() { return transferCommandPool; }
+  uint32_t getGraphicsQueueFamily() const { return graphicsQueueFamily; }
+  uint32_t getTransferQueueFamily() const { return transferQueueFamily; }
+  bool hasDedicatedTransferQueue() const { return transferQueueFamily != graphicsQueueFamily; }
+  // the lower of the instance and physical device versions, what the device may be used with
+  uint32_t getApiVersion() const { return deviceApiVersion; }
+  // timeline semaphores (Vulkan 1.2), enabled whenever the physical device has them
+  bool supportsTimelineSemaphores() const { return timelineSemaphoreSupported; }
+  // textureCompressionBC, enabled whenever the physical device has it
+  bool supportsBlockCompression() const { return blockCompressionSupported; }
+  // VK_EXT_memory_budget, enabled whenever the physical device has it
+  bool supportsMemoryBudget() const { return memoryBudgetSupported; }
+  // the descriptor indexing features LveBindlessTextures needs, enabled whenever all are there
+  bool supportsBindlessTextures() const { return bindlessTexturesSupported; }
 
   SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice); }
   uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
@@ -52,16 +75,22 @@ class LveDevice {
   VkFormat findSupportedFormat(
       const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
-  // Buffer Helper Functions
+  // sub-allocates the memory of every buffer and image below
+  LveAllocator &getAllocator() { return *allocator; }
+  // shared descriptor set layouts, see LveDescriptorSetLayout::Builder::buildCached()
+  LveDescriptorSetLayoutCache &getDescriptorSetLayoutCache() { return *descriptorSetLayoutCache; }
+
+  // Buffer Helper Functions, free the memory with getAllocator().free()
   void createBuffer(
       VkDeviceSize size,
       VkBufferUsageFlags usage,
       VkMemoryPropertyFlags properties,
       VkBuffer &buffer,
-      VkDeviceMemory &bufferMemory);
+      LveAllocation &bufferMemory);
   VkCommandBuffer beginSingleTimeCommands();
   void endSingleTimeCommands(VkCommandBuffer commandBuffer);
-  void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+  void copyBuffer(
+      VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset = 0);
   void copyBufferToImage(
       VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
 
@@ -69,7 +98,7 @@ class LveDevice {
       const VkImageCreateInfo &imageInfo,
       VkMemoryPropertyFlags properties,
       VkImage &image,
-      VkDeviceMemory &imageMemory);
+      LveAllocation &imageMemory);
 
   VkPhysicalDeviceProperties properties;
 
@@ -96,11 +125,24 @@ class LveDevice {
   VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
   LveWindow &window;
   VkCommandPool commandPool;
+  VkCommandPool transferCommandPool;
+  std::unique_ptr<LveAllocator> allocator;
+  std::unique_ptr<LveDescriptorSetLayoutCache> descriptorSetLayoutCache;
 
   VkDevice device_;
   VkSurfaceKHR surface_;
   VkQueue graphicsQueue_;
   VkQueue presentQueue_;
+  VkQueue transferQueue_;
+  uint32_t graphicsQueueFamily = 0;
+  uint32_t transferQueueFamily = 0;
+  // what the instance was created with, the highest the loader offers up to 1.2
+  uint32_t apiVersion = VK_API_VERSION_1_0;
+  uint32_t deviceApiVersion = VK_API_VERSION_1_0;
+  bool blockCompressionSupported = false;
+  bool timelineSemaphoreSupported = false;
+  bool memoryBudgetSupported = false;
+  bool bindlessTexturesSupported = false;
 
   const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
   const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
@@ -31,7 +31,7 @@ struct FrameInfo {
   VkCommandBuffer commandBuffer;
   LveCamera &camera;
   VkDescriptorSet globalDescriptorSet;
-  LveDescriptorPool &frameDescriptorPool;
   LveGameObject::Map &gameObjects;
+  VkExtent2D extent;
 };
 }  // namespace lve
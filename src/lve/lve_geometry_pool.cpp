@@ -0,0 +1,216 @@
+#include "lve_geometry_pool.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+
+LveGeometryPool::LveGeometryPool(
+    LveDevice &device,
+    LveUploadContext &uploadContext,
+    VkDeviceSize vertexBlockSize,
+    VkDeviceSize indexBlockSize)
+    : lveDevice{device},
+      uploadContext{uploadContext},
+      vertexBlockSize{vertexBlockSize},
+      indexBlockSize{indexBlockSize} {}
+
+LveGeometryPool::Allocation LveGeometryPool::allocateVertices(
+    const void *data, uint32_t stride, uint32_t count) {
+  assert(stride != kIndexBlock && "Vertex stride must not be zero");
+  // whole vertices per block, so the block size is rounded down to a multiple of the stride
+  return allocate(
+      data,
+      static_cast<VkDeviceSize>(stride) * count,
+      stride,
+      stride,
+      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+      vertexBlockSize / stride * stride);
+}
+
+LveGeometryPool::Allocation LveGeometryPool::allocateIndices(
+    const void *data, uint32_t indexSize, uint32_t count) {
+  return allocate(
+      data,
+      static_cast<VkDeviceSize>(indexSize) * count,
+      sizeof(uint32_t),
+      kIndexBlock,
+      VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+      indexBlockSize);
+}
+
+LveGeometryPool::Allocation LveGeometryPool::allocate(
+    const void *data,
+    VkDeviceSize size,
+    VkDeviceSize alignment,
+    uint32_t stride,
+    VkBufferUsageFlags usage,
+    VkDeviceSize blockSize) {
+  assert(size > 0 && "Cannot allocate empty geometry");
+
+  Allocation allocation = allocateRange(size, alignment, stride, usage, blockSize);
+  uploadContext.uploadBuffer(data, size, getBuffer(allocation), allocation.offset);
+  return allocation;
+}
+
+LveGeometryPool::Allocation LveGeometryPool::allocateRange(
+    VkDeviceSize size,
+    VkDeviceSize alignment,
+    uint32_t stride,
+    VkBufferUsageFlags usage,
+    VkDeviceSize blockSize) {
+  uint32_t freeSlot = kNoBlock;
+  for (uint32_t i = 0; i < blocks.size(); i++) {
+    if (blocks[i].buffer == nullptr) {
+      freeSlot = i;
+      continue;
+    }
+    if (blocks[i].stride != stride || blocks[i].evacuating) continue;
+    uint64_t offset = blocks[i].allocator.allocate(size, alignment);
+    if (offset != LveRangeAllocator::kInvalidOffset) {
+      return {i, offset, size};
+    }
+  }
+
+  // geometry bigger than a block gets a block of its own
+  VkDeviceSize capacity = std::max(blockSize, size);
+  Block block{
+      std::make_unique<LveBuffer>(
+          lveDevice,
+          capacity,
+          1,
+          usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+      LveRangeAllocator{capacity},
+      stride};
+  uint64_t offset = block.allocator.allocate(size, alignment);
+  if (freeSlot == kNoBlock) {
+    freeSlot = static_cast<uint32_t>(blocks.size());
+    blocks.push_back(std::move(block));
+  } else {
+    blocks[freeSlot] = std::move(block);
+  }
+  return {freeSlot, offset, size};
+}
+
+void LveGeometryPool::free(const Allocation &allocation) {
+  if (allocation.isValid()) {
+    // frames still in flight may read the range, and recorded uploads may still write it
+    retired.push_back({allocation, currentFrame, uploadContext.getBatchSerial()});
+  }
+}
+
+void LveGeometryPool::beginFrame(int frameIndex) {
+  currentFrame = frameIndex;
+  uploadContext.collect();
+  auto done = std::partition(retired.begin(), retired.end(), [&](Retired &range) {
+    if (range.frameIndex == frameIndex) {
+      range.frameIndex = kFrameDone;
+    }
+    return range.frameIndex != kFrameDone || !uploadContext.isBatchComplete(range.uploadBatch);
+  });
+  for (auto it = done; it != retired.end(); ++it) {
+    blocks[it->allocation.block].allocator.free(it->allocation.offset, it->allocation.size);
+  }
+  retired.erase(done, retired.end());
+}
+
+void LveGeometryPool::beginDefragmentation() {
+  // blocks only trade geometry with blocks of the same stride
+  std::vector<uint32_t> strides;
+  for (const auto &block : blocks) {
+    if (block.buffer != nullptr &&
+        std::find(strides.begin(), strides.end(), block.stride) == strides.end()) {
+      strides.push_back(block.stride);
+    }
+  }
+
+  for (uint32_t stride : strides) {
+    std::vector<uint32_t> candidates;
+    std::vector<const LveRangeAllocator *> allocators;
+    for (uint32_t i = 0; i < blocks.size(); i++) {
+      if (blocks[i].buffer != nullptr && blocks[i].stride == stride) {
+        candidates.push_back(i);
+        allocators.push_back(&blocks[i].allocator);
+      }
+    }
+    for (size_t i : selectAllocatorsToEvacuate(allocators)) {
+      blocks[candidates[i]].evacuating = true;
+    }
+  }
+}
+
+LveGeometryPool::Allocation LveGeometryPool::relocate(
+    VkCommandBuffer commandBuffer, const Allocation &allocation) {
+  // same alignment and block shape as allocateVertices / allocateIndices
+  uint32_t stride = blocks[allocation.block].stride;
+  Allocation moved = stride == kIndexBlock
+                         ? allocateRange(
+                               allocation.size,
+                               sizeof(uint32_t),
+                               stride,
+                               VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                               indexBlockSize)
+                         : allocateRange(
+                               allocation.size,
+                               stride,
+                               stride,
+                               VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                               vertexBlockSize / stride * stride);
+
+  VkBufferCopy copyRegion{};
+  copyRegion.srcOffset = allocation.offset;
+  copyRegion.dstOffset = moved.offset;
+  copyRegion.size = allocation.size;
+  vkCmdCopyBuffer(
+      commandBuffer,
+      blocks[allocation.block].buffer->getBuffer(),
+      getBuffer(moved),
+      1,
+      &copyRegion);
+  relocated.push_back(allocation);
+  return moved;
+}
+
+uint32_t LveGeometryPool::endDefragmentation() {
+  for (const auto &allocation : relocated) {
+    blocks[allocation.block].allocator.free(allocation.offset, allocation.size);
+  }
+  relocated.clear();
+  uint32_t released = 0;
+  for (auto &block : blocks) {
+    if (block.evacuating && block.allocator.isEmpty()) {
+      block.buffer.reset();
+      block.allocator = LveRangeAllocator{0};
+      released++;
+    }
+    block.evacuating = false;
+  }
+  return released;
+}
+
+uint32_t LveGeometryPool::getBlockCount() const {
+  return static_cast<uint32_t>(std::count_if(blocks.begin(), blocks.end(), [](const Block &block) {
+    return block.buffer != nullptr;
+  }));
+}
+
+VkDeviceSize LveGeometryPool::getAllocatedSize() const {
+  VkDeviceSize allocated = 0;
+  for (const auto &block : blocks) {
+    allocated += block.allocator.getCapacity() - block.allocator.getFreeSize();
+  }
+  return allocated;
+}
+
+VkDeviceSize LveGeometryPool::getReservedSize() const {
+  VkDeviceSize reserved = 0;
+  for (const auto &block : blocks) {
+    reserved += block.allocator.getCapacity();
+  }
+  return reserved;
+}
+
+}  // namespace lve
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "lve_buffer.hpp"
+#include "lve_device.hpp"
+#include "lve_range_allocator.hpp"
+#include "lve_upload_context.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace lve {
+
+/**
+ * Device local vertex and index storage shared by all models. Geometry is sub-allocated from a few
+ * large blocks, so a model costs no allocation of its own and consecutive draws from the same
+ * block skip the buffer binds, drawing through vertexOffset and firstIndex instead.
+ *
+ * Each vertex block only holds one stride, which keeps every offset a whole number of vertices.
+ * Index blocks are shared by both index types, offsets are 4 byte aligned so either type works.
+ */
+class LveGeometryPool {
+ public:
+  struct Allocation {
+    uint32_t block = kNoBlock;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+
+    bool isValid() const { return block != kNoBlock; }
+  };
+
+  // uploads are recorded into uploadContext, which has to outlive the pool
+  LveGeometryPool(
+      LveDevice &device,
+      LveUploadContext &uploadContext,
+      VkDeviceSize vertexBlockSize = 64 * 1024 * 1024,
+      VkDeviceSize indexBlockSize = 32 * 1024 * 1024);
+
+  LveGeometryPool(const LveGeometryPool &) = delete;
+  LveGeometryPool &operator=(const LveGeometryPool &) = delete;
+
+  // uploads count vertices of the given stride, the offset is a multiple of stride
+  Allocation allocateVertices(const void *data, uint32_t stride, uint32_t count);
+  // uploads count indices of indexSize bytes, the offset is a multiple of indexSize
+  Allocation allocateIndices(const void *data, uint32_t indexSize, uint32_t count);
+  /**
+   * The range is only reused after the GPU is done with it, see beginFrame(). Nothing waits for
+   * the GPU, so unloading a model never stalls the frames or uploads that follow.
+   */
+  void free(const Allocation &allocation);
+  /**
+   * Returns freed ranges to the free lists once the frame slot they were freed in comes around
+   * again and the upload batches recorded before they were freed completed. Call it once per
+   * frame, after the frame's fence has been waited for.
+   */
+  void beginFrame(int frameIndex);
+
+  /**
+   * Defragmentation, see LveAllocator::beginDefragmentation(): picks the emptiest blocks whose
+   * geometry fits into the other blocks of the same stride and allocates nothing new from them.
+   * Owners move what isEvacuating() with relocate(), endDefragmentation() then frees the moved
+   * ranges and releases the blocks that were emptied, returning how many. The GPU must be done
+   * with the moved ranges by then.
+   */
+  void beginDefragmentation();
+  bool isEvacuating(const Allocation &allocation) const {
+    return allocation.isValid() && blocks[allocation.block].evacuating;
+  }
+  // records a copy of the range into a block that stays, the old range is retired
+  Allocation relocate(VkCommandBuffer commandBuffer, const Allocation &allocation);
+  uint32_t endDefragmentation();
+
+  VkBuffer getBuffer(const Allocation &allocation) const {
+    return blocks[allocation.block].buffer->getBuffer();
+  }
+  LveDevice &getDevice() { return lveDevice; }
+  uint32_t getBlockCount() const;
+  VkDeviceSize getAllocatedSize() const;
+  // capacity of every block, allocated or not
+  VkDeviceSize getReservedSize() const;
+
+ private:
+  static constexpr uint32_t kNoBlock = ~0u;
+  static constexpr int kFrameDone = -1;
+  // stride of index blocks, they are not tied to one element size
+  static constexpr uint32_t kIndexBlock = 0;
+
+  // a released block keeps its slot with a null buffer, so the indices of the others stay valid
+  struct Block {
+    std::unique_ptr<LveBuffer> buffer;
+    LveRangeAllocator allocator;
+    uint32_t stride;
+    bool evacuating = false;
+  };
+  struct Retired {
+    Allocation allocation;
+    // frame slot it was freed in, kFrameDone once that slot came around again
+    int frameIndex;
+    // the last upload batch that may still write the range
+    uint64_t uploadBatch;
+  };
+
+  Allocation allocate(
+      const void *data,
+      VkDeviceSize size,
+      VkDeviceSize alignment,
+      uint32_t stride,
+      VkBufferUsageFlags usage,
+      VkDeviceSize blockSize);
+  // finds or creates room for size bytes, nothing is uploaded
+  Allocation allocateRange(
+      VkDeviceSize size,
+      VkDeviceSize alignment,
+      uint32_t stride,
+      VkBufferUsageFlags usage,
+      VkDeviceSize blockSize);
+
+  LveDevice &lveDevice;
+  LveUploadContext &uploadContext;
+  VkDeviceSize vertexBlockSize;
+  VkDeviceSize indexBlockSize;
+  std::vector<Block> blocks;
+  std::vector<Retired> retired;
+  // ranges relocate() moved away from, freed by endDefragmentation()
+  std::vector<Allocation> relocated;
+  int currentFrame = 0;
+};
+
+}  // namespace lve
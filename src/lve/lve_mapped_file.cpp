@@ -0,0 +1,101 @@
+#include "lve_mapped_file.hpp"
+
+// std
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lve {
+
+#ifdef _WIN32
+
+LveMappedFile::LveMappedFile(const std::string &filepath) : path{filepath} {
+  HANDLE file = CreateFileA(
+      filepath.c_str(),
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      nullptr,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+      nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("failed to open file: " + filepath);
+  }
+  fileHandle = file;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    throw std::runtime_error("failed to query file size: " + filepath);
+  }
+  fileSize = static_cast<size_t>(size.QuadPart);
+  if (fileSize == 0) {
+    return;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr) {
+    CloseHandle(file);
+    throw std::runtime_error("failed to map file: " + filepath);
+  }
+  mappingHandle = mapping;
+
+  mapped = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (mapped == nullptr) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    throw std::runtime_error("failed to map file: " + filepath);
+  }
+}
+
+LveMappedFile::~LveMappedFile() {
+  if (mapped) UnmapViewOfFile(mapped);
+  if (mappingHandle) CloseHandle(mappingHandle);
+  if (fileHandle) CloseHandle(fileHandle);
+}
+
+#else
+
+LveMappedFile::LveMappedFile(const std::string &filepath) : path{filepath} {
+  fileDescriptor = open(filepath.c_str(), O_RDONLY);
+  if (fileDescriptor < 0) {
+    throw std::runtime_error("failed to open file: " + filepath);
+  }
+
+  struct stat info;
+  if (fstat(fileDescriptor, &info) != 0) {
+    close(fileDescriptor);
+    throw std::runtime_error("failed to query file size: " + filepath);
+  }
+  fileSize = static_cast<size_t>(info.st_size);
+  if (fileSize == 0) {
+    return;
+  }
+
+  mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  if (mapped == MAP_FAILED) {
+    mapped = nullptr;
+    close(fileDescriptor);
+    throw std::runtime_error("failed to map file: " + filepath);
+  }
+  // we read everything front to back right away, let the kernel start paging it in
+  madvise(mapped, fileSize, MADV_WILLNEED);
+}
+
+LveMappedFile::~LveMappedFile() {
+  if (mapped) munmap(mapped, fileSize);
+  if (fileDescriptor >= 0) close(fileDescriptor);
+}
+
+#endif
+
+}  // namespace lve
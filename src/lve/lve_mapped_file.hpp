@@ -0,0 +1,39 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace lve {
+
+/**
+ * Read-only memory mapping of a whole file. The contents stay valid for the lifetime of the
+ * object, so data can be handed straight to a staging buffer without an intermediate copy.
+ */
+class LveMappedFile {
+ public:
+  explicit LveMappedFile(const std::string &filepath);
+  ~LveMappedFile();
+
+  LveMappedFile(const LveMappedFile &) = delete;
+  LveMappedFile &operator=(const LveMappedFile &) = delete;
+
+  const uint8_t *data() const { return static_cast<const uint8_t *>(mapped); }
+  size_t size() const { return fileSize; }
+  const std::string &getPath() const { return path; }
+
+ private:
+  std::string path;
+  void *mapped = nullptr;
+  size_t fileSize = 0;
+
+#ifdef _WIN32
+  void *fileHandle = nullptr;
+  void *mappingHandle = nullptr;
+#else
+  int fileDescriptor = -1;
+#endif
+};
+
+}  // namespace lve
@@ -0,0 +1,90 @@
+#include "lve_memory_stats.hpp"
+
+namespace lve {
+
+namespace {
+
+void writeUsage(const LveMemoryStats::Usage &usage, std::ostream &out) {
+  out << "\"reservedBytes\": " << usage.reservedBytes << ", \"usedBytes\": " << usage.usedBytes
+      << ", \"allocationCount\": " << usage.allocationCount
+      << ", \"blockCount\": " << usage.blockCount
+      << ", \"dedicatedCount\": " << usage.dedicatedCount;
+}
+
+}  // namespace
+
+const char *getMemoryCategoryName(LveMemoryCategory category) {
+  switch (category) {
+    case LveMemoryCategory::Vertex:
+      return "vertex";
+    case LveMemoryCategory::Index:
+      return "index";
+    case LveMemoryCategory::Texture:
+      return "texture";
+    case LveMemoryCategory::Uniform:
+      return "uniform";
+    case LveMemoryCategory::Staging:
+      return "staging";
+    case LveMemoryCategory::Depth:
+      return "depth";
+    case LveMemoryCategory::Other:
+      break;
+  }
+  return "other";
+}
+
+LveMemoryCategory getBufferMemoryCategory(VkBufferUsageFlags usage) {
+  if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT) return LveMemoryCategory::Vertex;
+  if (usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) return LveMemoryCategory::Index;
+  if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) return LveMemoryCategory::Uniform;
+  // only ever copied from
+  if (usage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT) return LveMemoryCategory::Staging;
+  return LveMemoryCategory::Other;
+}
+
+LveMemoryCategory getImageMemoryCategory(VkImageUsageFlags usage) {
+  if (usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) return LveMemoryCategory::Depth;
+  if (usage & VK_IMAGE_USAGE_SAMPLED_BIT) return LveMemoryCategory::Texture;
+  return LveMemoryCategory::Other;
+}
+
+void writeMemoryStatsJson(const LveMemoryStats &stats, std::ostream &out) {
+  out << "{\n  \"budgetAvailable\": " << (stats.budgetAvailable ? "true" : "false") << ",\n";
+  out << "  \"total\": {";
+  writeUsage(stats.total, out);
+  out << "},\n";
+
+  out << "  \"heaps\": [";
+  for (size_t i = 0; i < stats.heaps.size(); i++) {
+    const LveMemoryStats::Heap &heap = stats.heaps[i];
+    out << (i > 0 ? ",\n" : "\n") << "    {\"index\": " << i << ", \"size\": " << heap.size
+        << ", \"deviceLocal\": "
+        << ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "true" : "false")
+        << ", \"budget\": " << heap.budget << ", \"driverUsage\": " << heap.driverUsage << ", ";
+    writeUsage(heap.usage, out);
+    out << "}";
+  }
+  out << "\n  ],\n";
+
+  out << "  \"types\": [";
+  for (size_t i = 0; i < stats.types.size(); i++) {
+    const LveMemoryStats::Type &type = stats.types[i];
+    out << (i > 0 ? ",\n" : "\n") << "    {\"index\": " << i << ", \"heap\": " << type.heapIndex
+        << ", \"flags\": " << type.flags << ", ";
+    writeUsage(type.usage, out);
+    out << "}";
+  }
+  out << "\n  ],\n";
+
+  out << "  \"categories\": {";
+  for (uint32_t i = 0; i < kMemoryCategoryCount; i++) {
+    const LveMemoryStats::Usage &usage = stats.categories[i];
+    out << (i > 0 ? ",\n" : "\n") << "    \""
+        << getMemoryCategoryName(static_cast<LveMemoryCategory>(i))
+        << "\": {\"usedBytes\": " << usage.usedBytes
+        << ", \"allocationCount\": " << usage.allocationCount << "}";
+  }
+  out << "\n  }\n}\n";
+}
+
+}  // namespace lve
@@ -0,0 +1,71 @@
+#pragma once
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace lve {
+
+// what a piece of device memory is used for, derived from the usage flags of its resource
+enum class LveMemoryCategory : uint8_t {
+  Vertex,
+  Index,
+  Texture,
+  Uniform,
+  Staging,
+  Depth,
+  Other,
+};
+constexpr uint32_t kMemoryCategoryCount = 7;
+
+const char *getMemoryCategoryName(LveMemoryCategory category);
+LveMemoryCategory getBufferMemoryCategory(VkBufferUsageFlags usage);
+LveMemoryCategory getImageMemoryCategory(VkImageUsageFlags usage);
+
+/**
+ * Snapshot of the device memory the engine holds, see LveAllocator::getStats(). Reserved bytes
+ * are what vkAllocateMemory handed out (whole blocks and dedicated allocations), used bytes what
+ * resources occupy of that. The difference is free space inside blocks.
+ */
+struct LveMemoryStats {
+  struct Usage {
+    VkDeviceSize reservedBytes = 0;
+    VkDeviceSize usedBytes = 0;
+    uint32_t allocationCount = 0;
+    uint32_t blockCount = 0;
+    uint32_t dedicatedCount = 0;
+  };
+
+  struct Heap {
+    VkDeviceSize size = 0;
+    VkMemoryHeapFlags flags = 0;
+    Usage usage;
+    // from VK_EXT_memory_budget, whole process and every other user of the heap included. Without
+    // the extension budget is the heap size and driverUsage is the engine's reservedBytes
+    VkDeviceSize budget = 0;
+    VkDeviceSize driverUsage = 0;
+  };
+
+  struct Type {
+    VkMemoryPropertyFlags flags = 0;
+    uint32_t heapIndex = 0;
+    Usage usage;
+  };
+
+  std::vector<Heap> heaps;
+  std::vector<Type> types;
+  // reservedBytes, blockCount and dedicatedCount are only tracked per type and heap
+  std::array<Usage, kMemoryCategoryCount> categories{};
+  Usage total;
+  bool budgetAvailable = false;
+};
+
+// the whole snapshot as one JSON object
+void writeMemoryStatsJson(const LveMemoryStats &stats, std::ostream &out);
+
+}  // namespace lve
@@ -0,0 +1,207 @@
+#include "lve_mesh_cache.hpp"
+
+#include "lve_mapped_file.hpp"
+#include "lve_source_stamp.hpp"
+
+// std
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace lve {
+
+namespace {
+
+constexpr const char *kCacheExtension = ".lvemesh";
+
+static_assert(sizeof(LveMeshFileHeader) == 120, "LveMeshFileHeader must not contain padding");
+
+uint64_t alignOffset(uint64_t offset) {
+  return (offset + LveMeshFileHeader::kSectionAlignment - 1) &
+         ~(LveMeshFileHeader::kSectionAlignment - 1);
+}
+
+bool isCacheFile(const std::string &path) { return fs::path(path).extension() == kCacheExtension; }
+
+uint32_t getBuildFlags(const LveModel::Builder &builder) {
+  uint32_t flags = 0;
+  if (builder.allowCompactFormat) flags |= LveMeshFileHeader::kCompactFormatFlag;
+  if (builder.generateLodChain) flags |= LveMeshFileHeader::kLodChainFlag;
+  return flags;
+}
+
+bool isHeaderValid(const LveMeshFileHeader &header, size_t fileSize) {
+  if (header.magic != LveMeshFileHeader::kMagic ||
+      header.version != LveMeshFileHeader::kVersion ||
+      header.vertexFormat >= LveModel::kVertexFormatCount ||
+      header.vertexStride !=
+          LveModel::getVertexStride(static_cast<LveModel::VertexFormat>(header.vertexFormat)) ||
+      (header.indexSize != sizeof(uint32_t) && header.indexSize != sizeof(uint16_t))) {
+    return false;
+  }
+  uint64_t vertexBytes = static_cast<uint64_t>(header.vertexCount) * header.vertexStride;
+  uint64_t indexBytes = static_cast<uint64_t>(header.indexCount) * header.indexSize;
+  uint64_t meshletBytes = static_cast<uint64_t>(header.meshletCount) * sizeof(LveMeshlet);
+  uint64_t lodBytes = static_cast<uint64_t>(header.lodCount) * sizeof(LveModel::Lod);
+  return header.vertexOffset % LveMeshFileHeader::kSectionAlignment == 0 &&
+         header.indexOffset % LveMeshFileHeader::kSectionAlignment == 0 &&
+         header.meshletOffset % LveMeshFileHeader::kSectionAlignment == 0 &&
+         header.lodOffset % LveMeshFileHeader::kSectionAlignment == 0 &&
+         header.vertexOffset >= sizeof(LveMeshFileHeader) &&
+         header.vertexOffset + vertexBytes <= fileSize &&
+         header.indexOffset + indexBytes <= fileSize &&
+         header.meshletOffset + meshletBytes <= fileSize &&
+         header.lodOffset + lodBytes <= fileSize;
+}
+
+}  // namespace
+
+std::string meshCachePath(const std::string &sourcePath) {
+  return fs::path(sourcePath).replace_extension(kCacheExtension).string();
+}
+
+bool loadMeshCache(const std::string &sourcePath, LveModel::Builder &builder) {
+  const bool directLoad = isCacheFile(sourcePath);
+  const std::string cachePath = directLoad ? sourcePath : meshCachePath(sourcePath);
+
+  std::error_code ec;
+  if (!fs::exists(cachePath, ec)) {
+    if (directLoad) {
+      throw std::runtime_error("failed to open mesh cache: " + cachePath);
+    }
+    return false;
+  }
+
+  auto file = std::make_shared<LveMappedFile>(cachePath);
+  LveMeshFileHeader header{};
+  if (file->size() >= sizeof(header)) {
+    std::memcpy(&header, file->data(), sizeof(header));
+  }
+  if (!isHeaderValid(header, file->size())) {
+    if (directLoad) {
+      throw std::runtime_error("invalid or outdated mesh cache: " + cachePath);
+    }
+    return false;
+  }
+  if (!directLoad &&
+      !isSourceUnchanged(
+          sourcePath, {header.sourceSize, header.sourceModifiedTime, header.sourceHash})) {
+    return false;
+  }
+  if (!directLoad && header.buildFlags != getBuildFlags(builder)) {
+    return false;
+  }
+  auto vertexFormat = static_cast<LveModel::VertexFormat>(header.vertexFormat);
+
+  builder.vertices.clear();
+  builder.indices.clear();
+  builder.packedVertices.clear();
+  builder.meshlets.clear();
+  builder.packedIndices.clear();
+  builder.lods.clear();
+  builder.vertexFormat = vertexFormat;
+  builder.boundsMin = {header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]};
+  builder.boundsMax = {header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]};
+  builder.mappedVertices = file->data() + header.vertexOffset;
+  builder.mappedVertexCount = header.vertexCount;
+  builder.indexType =
+      header.indexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+  builder.mappedIndices = file->data() + header.indexOffset;
+  builder.mappedIndexCount = header.indexCount;
+  builder.mappedMeshlets =
+      reinterpret_cast<const LveMeshlet *>(file->data() + header.meshletOffset);
+  builder.mappedMeshletCount = header.meshletCount;
+  builder.mappedLods =
+      reinterpret_cast<const LveModel::Lod *>(file->data() + header.lodOffset);
+  builder.mappedLodCount = header.lodCount;
+  builder.mappedFile = std::move(file);
+  return true;
+}
+
+void writeMeshCache(const std::string &sourcePath, const LveModel::Builder &builder) {
+  LveMeshFileHeader header{};
+  header.magic = LveMeshFileHeader::kMagic;
+  header.version = LveMeshFileHeader::kVersion;
+  header.vertexStride = builder.getVertexStride();
+  header.vertexFormat = static_cast<uint32_t>(builder.vertexFormat);
+  header.vertexCount = builder.getVertexCount();
+  header.indexCount = builder.getIndexCount();
+  header.meshletCount = builder.getMeshletCount();
+  header.indexSize = builder.getIndexSize();
+  header.lodCount = builder.getLodCount();
+  header.buildFlags = getBuildFlags(builder);
+  for (int i = 0; i < 3; i++) {
+    header.boundsMin[i] = builder.boundsMin[i];
+    header.boundsMax[i] = builder.boundsMax[i];
+  }
+
+  LveSourceStamp stamp;
+  if (!stampSource(sourcePath, stamp)) {
+    return;
+  }
+  header.sourceSize = stamp.size;
+  header.sourceModifiedTime = stamp.modifiedTime;
+  header.sourceHash = stamp.hash;
+
+  uint64_t vertexBytes = static_cast<uint64_t>(header.vertexCount) * header.vertexStride;
+  uint64_t indexBytes = static_cast<uint64_t>(header.indexCount) * header.indexSize;
+  header.vertexOffset = alignOffset(sizeof(LveMeshFileHeader));
+  uint64_t meshletBytes = static_cast<uint64_t>(header.meshletCount) * sizeof(LveMeshlet);
+  header.indexOffset = alignOffset(header.vertexOffset + vertexBytes);
+  uint64_t lodBytes = static_cast<uint64_t>(header.lodCount) * sizeof(LveModel::Lod);
+  header.meshletOffset = alignOffset(header.indexOffset + indexBytes);
+  header.lodOffset = alignOffset(header.meshletOffset + meshletBytes);
+
+  // write to a temporary and rename so a crash or a concurrent reader never sees half a file
+  const std::string cachePath = meshCachePath(sourcePath);
+  const std::string tempPath = cachePath + ".tmp";
+  {
+    std::ofstream out{tempPath, std::ios::binary | std::ios::trunc};
+    if (!out) {
+      std::cerr << "failed to write mesh cache: " << cachePath << std::endl;
+      return;
+    }
+    const char padding[LveMeshFileHeader::kSectionAlignment]{};
+    auto pad = [&](uint64_t target) {
+      out.write(padding, static_cast<std::streamsize>(target - static_cast<uint64_t>(out.tellp())));
+    };
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    pad(header.vertexOffset);
+    out.write(
+        reinterpret_cast<const char *>(builder.getVertexData()),
+        static_cast<std::streamsize>(vertexBytes));
+    pad(header.indexOffset);
+    out.write(
+        reinterpret_cast<const char *>(builder.getIndexData()),
+        static_cast<std::streamsize>(indexBytes));
+    pad(header.meshletOffset);
+    out.write(
+        reinterpret_cast<const char *>(builder.getMeshletData()),
+        static_cast<std::streamsize>(meshletBytes));
+    pad(header.lodOffset);
+    out.write(
+        reinterpret_cast<const char *>(builder.getLodData()),
+        static_cast<std::streamsize>(lodBytes));
+    if (!out) {
+      std::cerr << "failed to write mesh cache: " << cachePath << std::endl;
+      out.close();
+      std::error_code ec;
+      fs::remove(tempPath, ec);
+      return;
+    }
+  }
+
+  std::error_code ec;
+  fs::rename(tempPath, cachePath, ec);
+  if (ec) {
+    std::cerr << "failed to write mesh cache: " << cachePath << " (" << ec.message() << ")"
+              << std::endl;
+    fs::remove(tempPath, ec);
+  }
+}
+
+}  // namespace lve
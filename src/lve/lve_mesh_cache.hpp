@@ -0,0 +1,64 @@
+#pragma once
+
+#include "lve_model.hpp"
+
+// std
+#include <cstdint>
+#include <string>
+
+namespace lve {
+
+/**
+ * On-disk layout of a cooked .lvemesh file. The header is followed by the vertex, index, meshlet
+ * and lod blobs, each starting at a kSectionAlignment aligned offset so they can be used in place from a mapping.
+ */
+struct LveMeshFileHeader {
+  static constexpr uint32_t kMagic = 0x4d45564c;  // "LVEM"
+  static constexpr uint32_t kVersion = 6;
+  static constexpr uint64_t kSectionAlignment = 16;
+  // buildFlags bits, one per LveModel::Builder option that changes the cooked geometry
+  static constexpr uint32_t kCompactFormatFlag = 1u << 0;
+  static constexpr uint32_t kLodChainFlag = 1u << 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t vertexStride;
+  uint32_t vertexCount;
+  uint32_t indexCount;
+  uint32_t vertexFormat;  // LveModel::VertexFormat
+  uint32_t meshletCount;
+  uint32_t indexSize;  // 2 or 4 bytes
+  uint32_t lodCount;
+  // a cache cooked with other builder options is stale, createPositionStream is not part of it
+  // since it only decides what gets uploaded from the cached vertices
+  uint32_t buildFlags;
+  float boundsMin[3];
+  float boundsMax[3];
+
+  // used to detect a stale cache, the hash is only checked when size or mtime changed
+  uint64_t sourceSize;
+  int64_t sourceModifiedTime;
+  uint64_t sourceHash;
+
+  uint64_t vertexOffset;
+  uint64_t indexOffset;
+  uint64_t meshletOffset;
+  uint64_t lodOffset;
+};
+
+// models/foo.obj -> models/foo.lvemesh
+std::string meshCachePath(const std::string &sourcePath);
+
+/**
+ * Maps the .lvemesh that belongs to sourcePath (or sourcePath itself if it is a .lvemesh) into
+ * builder. Returns false if there is no cache or it is out of date with its source.
+ */
+bool loadMeshCache(const std::string &sourcePath, LveModel::Builder &builder);
+
+/**
+ * Writes the builder geometry next to sourcePath. Failures are reported but not fatal, the model
+ * simply gets parsed again on the next launch.
+ */
+void writeMeshCache(const std::string &sourcePath, const LveModel::Builder &builder);
+
+}  // namespace lve
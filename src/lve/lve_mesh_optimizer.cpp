@@ -0,0 +1,207 @@
+#include "lve_mesh_optimizer.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace lve {
+
+namespace {
+
+constexpr uint32_t kUnused = ~0u;
+
+const glm::vec3 &positionAt(const glm::vec3 *positions, size_t stride, uint32_t vertex) {
+  return *reinterpret_cast<const glm::vec3 *>(
+      reinterpret_cast<const uint8_t *>(positions) + stride * vertex);
+}
+
+}  // namespace
+
+void optimizeVertexCache(
+    uint32_t *indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+  assert(indexCount % 3 == 0 && "Vertex cache optimization needs a triangle list");
+  const size_t triangleCount = indexCount / 3;
+  if (triangleCount == 0) {
+    return;
+  }
+
+  // triangles using each vertex, liveCount[v] of them are not emitted yet
+  std::vector<uint32_t> offsets(vertexCount + 1, 0);
+  for (size_t i = 0; i < indexCount; i++) {
+    offsets[indices[i] + 1]++;
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<uint32_t> liveCount(vertexCount);
+  for (size_t v = 0; v < vertexCount; v++) {
+    liveCount[v] = offsets[v + 1] - offsets[v];
+  }
+  std::vector<uint32_t> adjacency(indexCount);
+  {
+    std::vector<uint32_t> fill{offsets.begin(), offsets.end() - 1};
+    for (size_t i = 0; i < indexCount; i++) {
+      adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+  }
+
+  std::vector<uint32_t> input{indices, indices + indexCount};
+  std::vector<uint8_t> emitted(triangleCount, 0);
+  std::vector<uint32_t> cacheTime(vertexCount, 0);
+  std::vector<uint32_t> deadEnds;
+  std::vector<uint32_t> candidates;
+  uint32_t time = cacheSize + 1;
+  size_t scan = 0;
+  size_t written = 0;
+
+  uint32_t fanning = input[0];
+  while (fanning != kUnused) {
+    // emit every remaining triangle around the fanning vertex
+    candidates.clear();
+    for (uint32_t i = offsets[fanning]; i < offsets[fanning + 1]; i++) {
+      uint32_t triangle = adjacency[i];
+      if (emitted[triangle]) continue;
+      emitted[triangle] = 1;
+      for (uint32_t corner = 0; corner < 3; corner++) {
+        uint32_t vertex = input[triangle * 3 + corner];
+        indices[written++] = vertex;
+        deadEnds.push_back(vertex);
+        candidates.push_back(vertex);
+        liveCount[vertex]--;
+        if (time - cacheTime[vertex] > cacheSize) {
+          cacheTime[vertex] = time++;
+        }
+      }
+    }
+
+    // next fanning vertex: the oldest candidate that is still cached once its fan is emitted
+    fanning = kUnused;
+    int32_t bestPriority = -1;
+    for (uint32_t vertex : candidates) {
+      if (liveCount[vertex] == 0) continue;
+      int32_t priority = 0;
+      if (time - cacheTime[vertex] + 2 * liveCount[vertex] <= cacheSize) {
+        priority = static_cast<int32_t>(time - cacheTime[vertex]);
+      }
+      if (priority > bestPriority) {
+        bestPriority = priority;
+        fanning = vertex;
+      }
+    }
+    if (fanning != kUnused) continue;
+
+    // dead end, back off to a recently used vertex and then to any vertex with work left
+    while (!deadEnds.empty() && fanning == kUnused) {
+      uint32_t vertex = deadEnds.back();
+      deadEnds.pop_back();
+      if (liveCount[vertex] > 0) fanning = vertex;
+    }
+    while (fanning == kUnused && scan < vertexCount) {
+      if (liveCount[scan] > 0) fanning = static_cast<uint32_t>(scan);
+      scan++;
+    }
+  }
+  assert(written == indexCount && "Tipsify must emit every triangle");
+}
+
+void optimizeMeshletVertexCache(
+    std::vector<uint32_t> &indices, const std::vector<LveMeshlet> &meshlets, size_t vertexCount) {
+  std::vector<uint32_t> localSlots(vertexCount, kUnused);
+  std::vector<uint32_t> globalVertices;
+  std::vector<uint32_t> localIndices;
+  for (const auto &meshlet : meshlets) {
+    uint32_t *range = indices.data() + meshlet.firstIndex;
+    globalVertices.clear();
+    localIndices.resize(meshlet.indexCount);
+    for (uint32_t i = 0; i < meshlet.indexCount; i++) {
+      uint32_t &slot = localSlots[range[i]];
+      if (slot == kUnused) {
+        slot = static_cast<uint32_t>(globalVertices.size());
+        globalVertices.push_back(range[i]);
+      }
+      localIndices[i] = slot;
+    }
+
+    optimizeVertexCache(localIndices.data(), localIndices.size(), globalVertices.size());
+
+    for (uint32_t i = 0; i < meshlet.indexCount; i++) {
+      range[i] = globalVertices[localIndices[i]];
+    }
+    for (uint32_t vertex : globalVertices) {
+      localSlots[vertex] = kUnused;
+    }
+  }
+}
+
+void optimizeMeshletOverdraw(
+    const glm::vec3 *positions,
+    size_t positionStride,
+    std::vector<uint32_t> &indices,
+    std::vector<LveMeshlet> &meshlets) {
+  if (meshlets.size() < 2) {
+    return;
+  }
+
+  // area weighted centroid and normal per meshlet
+  std::vector<glm::vec3> centroids(meshlets.size(), glm::vec3{0.f});
+  std::vector<glm::vec3> normals(meshlets.size(), glm::vec3{0.f});
+  glm::vec3 meshCentroid{0.f};
+  float meshArea = 0.f;
+  for (size_t m = 0; m < meshlets.size(); m++) {
+    float area = 0.f;
+    const LveMeshlet &meshlet = meshlets[m];
+    for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i += 3) {
+      const glm::vec3 &a = positionAt(positions, positionStride, indices[i]);
+      const glm::vec3 &b = positionAt(positions, positionStride, indices[i + 1]);
+      const glm::vec3 &c = positionAt(positions, positionStride, indices[i + 2]);
+      glm::vec3 normal = glm::cross(b - a, c - a);
+      float triangleArea = glm::length(normal);
+      centroids[m] += (a + b + c) * (triangleArea / 3.f);
+      normals[m] += normal;
+      area += triangleArea;
+    }
+    meshCentroid += centroids[m];
+    meshArea += area;
+    centroids[m] = area > 0.f ? centroids[m] / area : meshlet.center;
+  }
+  meshCentroid = meshArea > 0.f ? meshCentroid / meshArea : glm::vec3{0.f};
+
+  std::vector<float> keys(meshlets.size());
+  for (size_t m = 0; m < meshlets.size(); m++) {
+    float length = glm::length(normals[m]);
+    keys[m] = length > 0.f ? glm::dot(centroids[m] - meshCentroid, normals[m] / length) : 0.f;
+  }
+  std::vector<uint32_t> order(meshlets.size());
+  std::iota(order.begin(), order.end(), 0u);
+  std::stable_sort(
+      order.begin(),
+      order.end(),
+      [&keys](uint32_t a, uint32_t b) { return keys[a] > keys[b]; });
+
+  std::vector<uint32_t> sortedIndices;
+  sortedIndices.reserve(indices.size());
+  std::vector<LveMeshlet> sortedMeshlets;
+  sortedMeshlets.reserve(meshlets.size());
+  for (uint32_t m : order) {
+    LveMeshlet meshlet = meshlets[m];
+    auto first = indices.begin() + meshlet.firstIndex;
+    meshlet.firstIndex = static_cast<uint32_t>(sortedIndices.size());
+    sortedIndices.insert(sortedIndices.end(), first, first + meshlet.indexCount);
+    sortedMeshlets.push_back(meshlet);
+  }
+  indices = std::move(sortedIndices);
+  meshlets = std::move(sortedMeshlets);
+}
+
+std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t> &indices, size_t vertexCount) {
+  std::vector<uint32_t> remap(vertexCount, kUnused);
+  uint32_t next = 0;
+  for (uint32_t &index : indices) {
+    if (remap[index] == kUnused) {
+      remap[index] = next++;
+    }
+    index = remap[index];
+  }
+  return remap;
+}
+
+}  // namespace lve
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "lve_meshlet.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+/**
+ * Reorders the triangles of a triangle list for a post-transform vertex cache of cacheSize
+ * entries (Tipsify, Sander et al. 2007). Runs in linear time and keeps every triangle's winding.
+ *
+ * @param vertexCount One past the largest index in indices
+ */
+void optimizeVertexCache(
+    uint32_t *indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16);
+
+/**
+ * Runs optimizeVertexCache() inside every meshlet, so the clusters stay contiguous.
+ */
+void optimizeMeshletVertexCache(
+    std::vector<uint32_t> &indices, const std::vector<LveMeshlet> &meshlets, size_t vertexCount);
+
+/**
+ * Sorts whole meshlets so the ones on the outside of the mesh, facing away from its centroid, are
+ * drawn first and occlude the rest. Updates indices and every meshlet's firstIndex.
+ */
+void optimizeMeshletOverdraw(
+    const glm::vec3 *positions,
+    size_t positionStride,
+    std::vector<uint32_t> &indices,
+    std::vector<LveMeshlet> &meshlets);
+
+/**
+ * Renumbers vertices in the order the index buffer first references them and rewrites indices.
+ * Returns the new position of every old vertex, or ~0u for vertices no triangle uses; the caller
+ * moves its vertex data accordingly.
+ */
+std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t> &indices, size_t vertexCount);
+
+}  // namespace lve
@@ -0,0 +1,250 @@
+#include "lve_mesh_simplifier.hpp"
+
+#include "lve_dedup_table.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+namespace lve {
+
+void LveMeshSimplifier::Quadric::addPlane(glm::vec3 normal, float distance, float area) {
+  double a = normal.x, b = normal.y, c = normal.z, d = distance;
+  a2 += area * a * a;
+  ab += area * a * b;
+  ac += area * a * c;
+  ad += area * a * d;
+  b2 += area * b * b;
+  bc += area * b * c;
+  bd += area * b * d;
+  c2 += area * c * c;
+  cd += area * c * d;
+  d2 += area * d * d;
+  weight += area;
+}
+
+void LveMeshSimplifier::Quadric::add(const Quadric &other) {
+  a2 += other.a2;
+  ab += other.ab;
+  ac += other.ac;
+  ad += other.ad;
+  b2 += other.b2;
+  bc += other.bc;
+  bd += other.bd;
+  c2 += other.c2;
+  cd += other.cd;
+  d2 += other.d2;
+  weight += other.weight;
+}
+
+double LveMeshSimplifier::Quadric::evaluate(glm::vec3 point) const {
+  if (weight <= 0.0) {
+    return 0.0;
+  }
+  double x = point.x, y = point.y, z = point.z;
+  double result = a2 * x * x + b2 * y * y + c2 * z * z + d2 +
+                  2.0 * (ab * x * y + ac * x * z + bc * y * z + ad * x + bd * y + cd * z);
+  return std::max(result, 0.0) / weight;
+}
+
+LveMeshSimplifier::LveMeshSimplifier(
+    const glm::vec3 *positions,
+    size_t positionStride,
+    size_t vertexCount,
+    const std::vector<uint32_t> &indices)
+    : positions{reinterpret_cast<const uint8_t *>(positions)},
+      positionStride{positionStride},
+      vertexCount{vertexCount},
+      indices{indices},
+      remap(vertexCount) {
+  assert(indices.size() % 3 == 0 && "Simplification needs a triangle list");
+  std::iota(remap.begin(), remap.end(), 0u);
+  classifyVertices();
+}
+
+void LveMeshSimplifier::classifyVertices() {
+  std::vector<glm::vec3> uniquePositions;
+  LveDedupTable<glm::vec3> positionTable{uniquePositions, vertexCount};
+  positionIds.resize(vertexCount);
+  for (uint32_t v = 0; v < vertexCount; v++) {
+    positionIds[v] = positionTable.insert(position(v));
+  }
+
+  positionVariants.assign(uniquePositions.size(), 0);
+  for (uint32_t v = 0; v < vertexCount; v++) {
+    positionVariants[positionIds[v]]++;
+  }
+  locked.assign(uniquePositions.size(), 0);
+  for (size_t id = 0; id < uniquePositions.size(); id++) {
+    locked[id] = positionVariants[id] > 1;
+  }
+
+  // every manifold interior edge is used by exactly two triangles
+  std::vector<uint64_t> edges;
+  edges.reserve(indices.size());
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    for (size_t corner = 0; corner < 3; corner++) {
+      uint64_t a = positionIds[indices[i + corner]];
+      uint64_t b = positionIds[indices[i + (corner + 1) % 3]];
+      if (a == b) continue;
+      edges.push_back(a < b ? (a << 32 | b) : (b << 32 | a));
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  for (size_t i = 0; i < edges.size();) {
+    size_t end = i + 1;
+    while (end < edges.size() && edges[end] == edges[i]) end++;
+    if (end - i != 2) {
+      locked[edges[i] >> 32] = 1;
+      locked[edges[i] & 0xffffffffu] = 1;
+    }
+    i = end;
+  }
+
+  quadrics.assign(uniquePositions.size(), Quadric{});
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    const glm::vec3 &p0 = position(indices[i]);
+    glm::vec3 normal = glm::cross(position(indices[i + 1]) - p0, position(indices[i + 2]) - p0);
+    float length = glm::length(normal);
+    if (length <= 0.f) continue;
+    normal /= length;
+    for (size_t corner = 0; corner < 3; corner++) {
+      quadrics[positionIds[indices[i + corner]]].addPlane(
+          normal,
+          -glm::dot(normal, p0),
+          length * .5f);
+    }
+  }
+}
+
+void LveMeshSimplifier::buildAdjacency() {
+  adjacencyOffsets.assign(vertexCount + 1, 0);
+  for (uint32_t index : indices) {
+    adjacencyOffsets[index + 1]++;
+  }
+  std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+  adjacency.resize(indices.size());
+  std::vector<uint32_t> fill{adjacencyOffsets.begin(), adjacencyOffsets.end() - 1};
+  for (size_t i = 0; i < indices.size(); i++) {
+    adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+  }
+}
+
+void LveMeshSimplifier::gatherCollapses(
+    std::vector<Collapse> &collapses, float maxError) const {
+  // every edge shows up once per triangle and direction, the duplicates are skipped when applying
+  collapses.clear();
+  const float maxCost = maxError * maxError;
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    for (size_t corner = 0; corner < 3; corner++) {
+      for (size_t other = 1; other < 3; other++) {
+        uint32_t from = indices[i + corner];
+        uint32_t to = indices[i + (corner + other) % 3];
+        uint32_t fromId = positionIds[from];
+        uint32_t toId = positionIds[to];
+        if (locked[fromId] || fromId == toId) continue;
+        Quadric quadric = quadrics[fromId];
+        quadric.add(quadrics[toId]);
+        float cost = static_cast<float>(quadric.evaluate(position(to)));
+        if (cost <= maxCost) {
+          collapses.push_back({from, to, cost});
+        }
+      }
+    }
+  }
+  std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) {
+    return a.cost < b.cost;
+  });
+}
+
+bool LveMeshSimplifier::isCollapseValid(uint32_t from, uint32_t to) const {
+  const glm::vec3 &target = position(to);
+  for (uint32_t i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; i++) {
+    const uint32_t *triangle = &indices[adjacency[i] * 3];
+    glm::vec3 corners[3];
+    glm::vec3 moved[3];
+    bool collapses = false;
+    for (int corner = 0; corner < 3; corner++) {
+      if (positionIds[triangle[corner]] == positionIds[to]) {
+        // a seam vertex only works as a target if every triangle along the edge agrees on which
+        // of its variants to use
+        if (triangle[corner] != to) return false;
+        collapses = true;
+      }
+      corners[corner] = position(triangle[corner]);
+      moved[corner] = triangle[corner] == from ? target : corners[corner];
+    }
+    if (collapses) continue;  // becomes degenerate and is dropped
+    glm::vec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+    glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+    if (glm::dot(before, after) <= 0.f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t LveMeshSimplifier::applyCollapses(
+    const std::vector<Collapse> &collapses, size_t targetIndexCount) {
+  // one collapse per neighbourhood and pass, so flip checks always see the current surface
+  std::vector<uint8_t> touched(positionVariants.size(), 0);
+  size_t indexCount = indices.size();
+  size_t applied = 0;
+  for (const auto &collapse : collapses) {
+    if (indexCount <= targetIndexCount) break;
+    uint32_t fromId = positionIds[collapse.from];
+    uint32_t toId = positionIds[collapse.to];
+    if (touched[fromId] || touched[toId] || !isCollapseValid(collapse.from, collapse.to)) continue;
+
+    for (uint32_t i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1];
+         i++) {
+      const uint32_t *triangle = &indices[adjacency[i] * 3];
+      bool degenerate = false;
+      for (int corner = 0; corner < 3; corner++) {
+        touched[positionIds[triangle[corner]]] = 1;
+        degenerate |= positionIds[triangle[corner]] == toId;
+      }
+      if (degenerate) indexCount -= 3;
+    }
+    remap[collapse.from] = collapse.to;
+    quadrics[toId].add(quadrics[fromId]);
+    error = std::max(error, std::sqrt(collapse.cost));
+    applied++;
+  }
+  return applied;
+}
+
+void LveMeshSimplifier::compactIndices() {
+  size_t written = 0;
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    uint32_t a = remap[indices[i]];
+    uint32_t b = remap[indices[i + 1]];
+    uint32_t c = remap[indices[i + 2]];
+    if (positionIds[a] == positionIds[b] || positionIds[b] == positionIds[c] ||
+        positionIds[a] == positionIds[c]) {
+      continue;
+    }
+    indices[written++] = a;
+    indices[written++] = b;
+    indices[written++] = c;
+  }
+  indices.resize(written);
+  std::iota(remap.begin(), remap.end(), 0u);
+}
+
+float LveMeshSimplifier::simplify(size_t targetIndexCount, float maxError) {
+  std::vector<Collapse> collapses;
+  while (indices.size() > targetIndexCount) {
+    buildAdjacency();
+    gatherCollapses(collapses, maxError);
+    if (applyCollapses(collapses, targetIndexCount) == 0) {
+      break;
+    }
+    compactIndices();
+  }
+  return error;
+}
+
+}  // namespace lve
@@ -0,0 +1,93 @@
+#pragma once
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+/**
+ * Quadric error edge collapse simplifier (Garland & Heckbert) for building LOD chains. Vertices
+ * only ever collapse onto other existing vertices, so every level indexes the original vertex
+ * buffer.
+ *
+ * Vertices that share a position but not their attributes (uv or normal seams), that sit on an
+ * open border or on non-manifold edges are locked in place, which keeps seams and silhouettes
+ * intact at the cost of less reduction on heavily split meshes.
+ *
+ * simplify() can be called repeatedly with falling targets, each call continues from the last.
+ */
+class LveMeshSimplifier {
+ public:
+  LveMeshSimplifier(
+      const glm::vec3 *positions,
+      size_t positionStride,
+      size_t vertexCount,
+      const std::vector<uint32_t> &indices);
+
+  /**
+   * Collapses edges until at most targetIndexCount indices remain or the next collapse would move
+   * the surface by more than maxError (model space units).
+   *
+   * @return the largest error of any collapse so far
+   */
+  float simplify(size_t targetIndexCount, float maxError);
+
+  const std::vector<uint32_t> &getIndices() const { return indices; }
+  float getError() const { return error; }
+
+ private:
+  // plane quadric, symmetric 4x4 stored as its upper triangle, weighted by triangle area
+  struct Quadric {
+    double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2, weight;
+
+    void addPlane(glm::vec3 normal, float distance, float area);
+    void add(const Quadric &other);
+    // squared distance to the accumulated planes, averaged over their area
+    double evaluate(glm::vec3 point) const;
+  };
+
+  struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    float cost;  // squared distance
+  };
+
+  const glm::vec3 &position(uint32_t vertex) const {
+    return *reinterpret_cast<const glm::vec3 *>(positions + positionStride * vertex);
+  }
+
+  void classifyVertices();
+  void buildAdjacency();
+  void gatherCollapses(std::vector<Collapse> &collapses, float maxError) const;
+  // rejects collapses that flip a triangle or tear a seam
+  bool isCollapseValid(uint32_t from, uint32_t to) const;
+  size_t applyCollapses(const std::vector<Collapse> &collapses, size_t targetIndexCount);
+  void compactIndices();
+
+  const uint8_t *positions;
+  size_t positionStride;
+  size_t vertexCount;
+
+  std::vector<uint32_t> indices;
+  float error = 0.f;
+
+  // vertices with bitwise identical positions share a position id, quadrics live per position
+  std::vector<uint32_t> positionIds;
+  std::vector<uint32_t> positionVariants;
+  std::vector<uint8_t> locked;
+  std::vector<Quadric> quadrics;
+
+  // vertex -> triangles of the current indices, rebuilt every pass
+  std::vector<uint32_t> adjacencyOffsets;
+  std::vector<uint32_t> adjacency;
+  std::vector<uint32_t> remap;
+};
+
+}  // namespace lve
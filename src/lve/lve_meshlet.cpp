@@ -0,0 +1,277 @@
+#include "lve_meshlet.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace lve {
+
+namespace {
+
+constexpr uint32_t kNoTriangle = std::numeric_limits<uint32_t>::max();
+constexpr uint8_t kNotInMeshlet = 0xff;
+
+static_assert(LveMeshlet::kMaxVertices < kNotInMeshlet, "local vertex slots must fit a byte");
+
+// triangles using each vertex, CSR style
+struct TriangleAdjacency {
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> triangles;
+
+  TriangleAdjacency(const std::vector<uint32_t> &indices, size_t vertexCount) {
+    offsets.assign(vertexCount + 1, 0);
+    for (uint32_t index : indices) {
+      offsets[index + 1]++;
+    }
+    for (size_t i = 0; i < vertexCount; i++) {
+      offsets[i + 1] += offsets[i];
+    }
+    triangles.resize(indices.size());
+    std::vector<uint32_t> fill{offsets.begin(), offsets.end() - 1};
+    for (size_t i = 0; i < indices.size(); i++) {
+      triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+  }
+};
+
+class MeshletBuilder {
+ public:
+  MeshletBuilder(
+      const glm::vec3 *positions,
+      size_t positionStride,
+      size_t vertexCount,
+      const std::vector<uint32_t> &indices)
+      : positions{reinterpret_cast<const uint8_t *>(positions)},
+        positionStride{positionStride},
+        indices{indices},
+        adjacency{indices, vertexCount},
+        emitted(indices.size() / 3, 0),
+        localSlots(vertexCount, kNotInMeshlet) {}
+
+  std::vector<LveMeshlet> build(std::vector<uint32_t> &reordered) {
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    reordered.clear();
+    reordered.reserve(indices.size());
+
+    uint32_t cursor = 0;
+    for (;;) {
+      uint32_t triangle = pickNeighbour();
+      if (triangle == kNoTriangle) {
+        while (cursor < triangleCount && emitted[cursor]) cursor++;
+        if (cursor == triangleCount) break;
+        triangle = cursor;
+      }
+      if (meshletVertices.size() + newVertexCount(triangle) > LveMeshlet::kMaxVertices ||
+          meshletTriangles.size() + 1 > LveMeshlet::kMaxTriangles) {
+        finishMeshlet(reordered);
+      }
+      addTriangle(triangle);
+    }
+    finishMeshlet(reordered);
+    return std::move(meshlets);
+  }
+
+ private:
+  const glm::vec3 &position(uint32_t vertex) const {
+    return *reinterpret_cast<const glm::vec3 *>(positions + positionStride * vertex);
+  }
+
+  glm::vec3 triangleCentroid(uint32_t triangle) const {
+    return (position(indices[triangle * 3]) + position(indices[triangle * 3 + 1]) +
+            position(indices[triangle * 3 + 2])) /
+           3.f;
+  }
+
+  uint32_t newVertexCount(uint32_t triangle) const {
+    uint32_t count = 0;
+    for (uint32_t corner = 0; corner < 3; corner++) {
+      count += localSlots[indices[triangle * 3 + corner]] == kNotInMeshlet;
+    }
+    return count;
+  }
+
+  // best unemitted triangle sharing vertex, fewest new vertices first, then closest to the middle
+  void scoreNeighbours(uint32_t vertex, uint32_t &best, uint32_t &bestNew, float &bestDistance) {
+    for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; i++) {
+      uint32_t triangle = adjacency.triangles[i];
+      if (emitted[triangle]) continue;
+      uint32_t added = newVertexCount(triangle);
+      glm::vec3 offset = triangleCentroid(triangle) - centroidSum / float(meshletTriangles.size());
+      float distance = glm::dot(offset, offset);
+      if (added < bestNew || (added == bestNew && distance < bestDistance)) {
+        best = triangle;
+        bestNew = added;
+        bestDistance = distance;
+      }
+    }
+  }
+
+  uint32_t pickNeighbour() {
+    if (meshletTriangles.empty()) return kNoTriangle;
+    uint32_t best = kNoTriangle;
+    uint32_t bestNew = 4;
+    float bestDistance = std::numeric_limits<float>::max();
+    // the last triangle's neighbours are enough most of the time and keep this O(1)
+    uint32_t last = meshletTriangles.back();
+    for (uint32_t corner = 0; corner < 3; corner++) {
+      scoreNeighbours(indices[last * 3 + corner], best, bestNew, bestDistance);
+    }
+    if (best == kNoTriangle) {
+      for (uint32_t vertex : meshletVertices) {
+        scoreNeighbours(vertex, best, bestNew, bestDistance);
+      }
+    }
+    return best;
+  }
+
+  void addTriangle(uint32_t triangle) {
+    for (uint32_t corner = 0; corner < 3; corner++) {
+      uint32_t vertex = indices[triangle * 3 + corner];
+      if (localSlots[vertex] == kNotInMeshlet) {
+        localSlots[vertex] = static_cast<uint8_t>(meshletVertices.size());
+        meshletVertices.push_back(vertex);
+      }
+    }
+    emitted[triangle] = 1;
+    meshletTriangles.push_back(triangle);
+    centroidSum += triangleCentroid(triangle);
+  }
+
+  void finishMeshlet(std::vector<uint32_t> &reordered) {
+    if (meshletTriangles.empty()) return;
+
+    LveMeshlet meshlet{};
+    meshlet.firstIndex = static_cast<uint32_t>(reordered.size());
+    meshlet.indexCount = static_cast<uint32_t>(meshletTriangles.size() * 3);
+
+    glm::vec3 boundsMin = position(meshletVertices[0]);
+    glm::vec3 boundsMax = boundsMin;
+    for (uint32_t vertex : meshletVertices) {
+      boundsMin = glm::min(boundsMin, position(vertex));
+      boundsMax = glm::max(boundsMax, position(vertex));
+    }
+    meshlet.center = (boundsMin + boundsMax) * .5f;
+    for (uint32_t vertex : meshletVertices) {
+      glm::vec3 offset = position(vertex) - meshlet.center;
+      meshlet.radius = std::max(meshlet.radius, std::sqrt(glm::dot(offset, offset)));
+      localSlots[vertex] = kNotInMeshlet;
+    }
+
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshletTriangles.size());
+    glm::vec3 normalSum{0.f};
+    for (uint32_t triangle : meshletTriangles) {
+      const glm::vec3 &a = position(indices[triangle * 3]);
+      const glm::vec3 &b = position(indices[triangle * 3 + 1]);
+      const glm::vec3 &c = position(indices[triangle * 3 + 2]);
+      reordered.insert(reordered.end(), &indices[triangle * 3], &indices[triangle * 3] + 3);
+
+      glm::vec3 normal = glm::cross(b - a, c - a);
+      float length = std::sqrt(glm::dot(normal, normal));
+      if (length > 0.f) {  // degenerate triangles never render, they don't widen the cone
+        normals.push_back(normal / length);
+        normalSum += normals.back();
+      }
+    }
+
+    meshlet.coneAxis = glm::vec3{0.f, 0.f, 1.f};
+    meshlet.coneCutoff = 1.f;
+    float axisLength = std::sqrt(glm::dot(normalSum, normalSum));
+    if (axisLength > 0.f) {
+      meshlet.coneAxis = normalSum / axisLength;
+      float minDot = 1.f;
+      for (const glm::vec3 &normal : normals) {
+        minDot = std::min(minDot, glm::dot(normal, meshlet.coneAxis));
+      }
+      if (minDot > 0.f) {
+        meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+      }
+    }
+
+    meshlets.push_back(meshlet);
+    meshletVertices.clear();
+    meshletTriangles.clear();
+    centroidSum = glm::vec3{0.f};
+  }
+
+  const uint8_t *positions;
+  size_t positionStride;
+  const std::vector<uint32_t> &indices;
+  TriangleAdjacency adjacency;
+
+  std::vector<uint8_t> emitted;
+  std::vector<uint8_t> localSlots;  // vertex -> position in meshletVertices
+
+  std::vector<uint32_t> meshletVertices;
+  std::vector<uint32_t> meshletTriangles;
+  glm::vec3 centroidSum{0.f};
+  std::vector<LveMeshlet> meshlets;
+};
+
+}  // namespace
+
+LveClusterCullInfo::LveClusterCullInfo(
+    const LveCamera &camera, const glm::mat4 &modelMatrix, bool coneCulling)
+    : coneCulling{coneCulling} {
+  // planes of the clip volume (Gribb/Hartmann) pulled back into model space, depth is [0, 1]
+  glm::mat4 clip = camera.getProjection() * camera.getView() * modelMatrix;
+  glm::vec4 rows[4];
+  for (int i = 0; i < 4; i++) {
+    rows[i] = {clip[0][i], clip[1][i], clip[2][i], clip[3][i]};
+  }
+  frustumPlanes[0] = rows[3] + rows[0];
+  frustumPlanes[1] = rows[3] - rows[0];
+  frustumPlanes[2] = rows[3] + rows[1];
+  frustumPlanes[3] = rows[3] - rows[1];
+  frustumPlanes[4] = rows[2];
+  frustumPlanes[5] = rows[3] - rows[2];
+  for (auto &plane : frustumPlanes) {
+    plane /= std::sqrt(glm::dot(glm::vec3{plane}, glm::vec3{plane}));
+  }
+
+  cameraPosition = glm::vec3{glm::inverse(modelMatrix) * glm::vec4{camera.getPosition(), 1.f}};
+}
+
+bool LveClusterCullInfo::isSphereVisible(glm::vec3 center, float radius) const {
+  for (const auto &plane : frustumPlanes) {
+    if (glm::dot(glm::vec3{plane}, center) + plane.w < -radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LveClusterCullInfo::isMeshletVisible(const LveMeshlet &meshlet) const {
+  if (!isSphereVisible(meshlet.center, meshlet.radius)) {
+    return false;
+  }
+  if (coneCulling) {
+    // back facing when the whole sphere sees every normal in the cone from behind
+    glm::vec3 toCenter = meshlet.center - cameraPosition;
+    float distance = std::sqrt(glm::dot(toCenter, toCenter));
+    if (glm::dot(toCenter, meshlet.coneAxis) >= meshlet.coneCutoff * distance + meshlet.radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<LveMeshlet> buildMeshlets(
+    const glm::vec3 *positions,
+    size_t positionStride,
+    size_t vertexCount,
+    std::vector<uint32_t> &indices) {
+  assert(indices.size() % 3 == 0 && "Meshlets need a triangle list");
+  if (indices.empty()) {
+    return {};
+  }
+  std::vector<uint32_t> reordered;
+  std::vector<LveMeshlet> meshlets =
+      MeshletBuilder{positions, positionStride, vertexCount, indices}.build(reordered);
+  indices = std::move(reordered);
+  return meshlets;
+}
+
+}  // namespace lve
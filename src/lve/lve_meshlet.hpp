@@ -0,0 +1,64 @@
+#pragma once
+
+#include "lve_camera.hpp"
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+/**
+ * A cluster of up to kMaxTriangles triangles stored contiguously in the index buffer, with
+ * model space bounds for culling.
+ */
+struct LveMeshlet {
+  static constexpr uint32_t kMaxVertices = 64;
+  static constexpr uint32_t kMaxTriangles = 124;
+
+  glm::vec3 center;
+  float radius;
+  // every triangle normal (counter-clockwise front faces, like OBJ) lies within the cone around
+  // coneAxis, coneCutoff is the sine of its half angle, 1 when the cone is too wide to ever cull
+  glm::vec3 coneAxis;
+  float coneCutoff;
+  uint32_t firstIndex;
+  uint32_t indexCount;
+};
+
+/**
+ * Frustum planes and camera position transformed into the model space of a single draw, so the
+ * meshlet bounds can be tested without transforming them.
+ */
+struct LveClusterCullInfo {
+  glm::vec4 frustumPlanes[6];  // xyz normalized, inside is dot(xyz, p) + w >= 0
+  glm::vec3 cameraPosition;
+  // only valid when the pipeline culls back faces, otherwise they are visible
+  bool coneCulling;
+
+  LveClusterCullInfo(const LveCamera &camera, const glm::mat4 &modelMatrix, bool coneCulling);
+
+  bool isSphereVisible(glm::vec3 center, float radius) const;
+  bool isMeshletVisible(const LveMeshlet &meshlet) const;
+};
+
+/**
+ * Groups the triangles of indices into meshlets, reordering indices so every meshlet is a
+ * contiguous range. Triangles are added greedily, preferring neighbours that bring in the fewest
+ * new vertices so the clusters stay compact and their normal cones tight.
+ *
+ * @param positions First vertex position, consecutive positions are positionStride bytes apart
+ */
+std::vector<LveMeshlet> buildMeshlets(
+    const glm::vec3 *positions,
+    size_t positionStride,
+    size_t vertexCount,
+    std::vector<uint32_t> &indices);
+
+}  // namespace lve
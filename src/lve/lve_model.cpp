@@ -1,124 +1,280 @@
 #include "lve_model.hpp"
 
-#include "lve_utils.hpp"
+#include "lve_dedup_table.hpp"
+#include "lve_mesh_cache.hpp"
+#include "lve_mesh_optimizer.hpp"
+#include "lve_mesh_simplifier.hpp"
+#include "lve_obj_parser.hpp"
+#include "lve_vertex_encoding.hpp"
 
 // libs
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "tiny_obj_loader.h"
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 
 // std
+#include <algorithm>
 #include <cassert>
 #include <cstring>
-#include <unordered_map>
+#include <limits>
 
 #ifndef ENGINE_DIR
 #define ENGINE_DIR "../"
 #endif
 
-namespace std {
-template <>
-struct hash<lve::LveModel::Vertex> {
-  size_t operator()(lve::LveModel::Vertex const &vertex) const {
-    size_t seed = 0;
-    lve::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-    return seed;
-  }
-};
-}  // namespace std
-
 namespace lve {
 
-LveModel::LveModel(LveDevice &device, const LveModel::Builder &builder) : lveDevice{device} {
-  createVertexBuffers(builder.vertices);
-  createIndexBuffers(builder.indices);
+namespace {
+
+// small props are cheap enough at full detail
+constexpr size_t kMinLodTriangles = 256;
+constexpr float kLodTriangleRatios[] = {.5f, .25f, .125f};
+// largest allowed simplification error, relative to the bounding box diagonal
+constexpr float kMaxLodError = .02f;
+// stop the chain once a level keeps more than this fraction of the previous one
+constexpr float kMinLodReduction = .8f;
+
+}  // namespace
+
+LveModel::LveModel(LveGeometryPool &pool, const LveModel::Builder &builder)
+    : geometryPool{pool},
+      vertexFormat{builder.vertexFormat},
+      boundsMin{builder.boundsMin},
+      boundsMax{builder.boundsMax},
+      indexType{builder.indexType} {
+  createVertexBuffers(
+      builder.getVertexData(),
+      builder.getVertexStride(),
+      builder.getVertexCount());
+  if (builder.createPositionStream) {
+    createPositionBuffer(
+        builder.getVertexData(),
+        builder.getVertexStride(),
+        builder.getVertexCount());
+  }
+  createIndexBuffers(builder.getIndexData(), builder.getIndexCount());
+  meshlets.assign(
+      builder.getMeshletData(),
+      builder.getMeshletData() + builder.getMeshletCount());
+  lods.assign(builder.getLodData(), builder.getLodData() + builder.getLodCount());
+  if (lods.empty()) {
+    lods.push_back({0, indexCount, 0.f});
+  }
 }
 
-LveModel::~LveModel() {}
+LveModel::~LveModel() {
+  geometryPool.free(vertexAllocation);
+  geometryPool.free(positionAllocation);
+  geometryPool.free(indexAllocation);
+}
 
 std::unique_ptr<LveModel> LveModel::createModelFromFile(
-    LveDevice &device, const std::string &filepath) {
+    LveGeometryPool &pool, const std::string &filepath) {
   Builder builder{};
   builder.loadModel(ENGINE_DIR + filepath);
-  return std::make_unique<LveModel>(device, builder);
+  return std::make_unique<LveModel>(pool, builder);
 }
 
-void LveModel::createVertexBuffers(const std::vector<Vertex> &vertices) {
-  vertexCount = static_cast<uint32_t>(vertices.size());
+void LveModel::createVertexBuffers(const void *vertices, uint32_t stride, uint32_t count) {
+  vertexCount = count;
   assert(vertexCount >= 3 && "Vertex count must be at least 3");
-  VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexCount;
-  uint32_t vertexSize = sizeof(vertices[0]);
-
-  LveBuffer stagingBuffer{
-      lveDevice,
-      vertexSize,
-      vertexCount,
-      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-  };
-
-  stagingBuffer.map();
-  stagingBuffer.writeToBuffer((void *)vertices.data());
-
-  vertexBuffer = std::make_unique<LveBuffer>(
-      lveDevice,
-      vertexSize,
-      vertexCount,
-      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  vertexAllocation = geometryPool.allocateVertices(vertices, stride, vertexCount);
+  vertexOffset = static_cast<int32_t>(vertexAllocation.offset / stride);
+}
 
-  lveDevice.copyBuffer(stagingBuffer.getBuffer(), vertexBuffer->getBuffer(), bufferSize);
+void LveModel::createPositionBuffer(const void *vertices, uint32_t stride, uint32_t count) {
+  // positions lead both vertex layouts, so the stream is the front of every vertex
+  uint32_t positionStride = getPositionStride(vertexFormat);
+  std::vector<uint8_t> positions(static_cast<size_t>(positionStride) * count);
+  const uint8_t *source = static_cast<const uint8_t *>(vertices);
+  for (uint32_t i = 0; i < count; i++) {
+    std::memcpy(
+        &positions[static_cast<size_t>(i) * positionStride],
+        source + static_cast<size_t>(i) * stride,
+        positionStride);
+  }
+  positionAllocation = geometryPool.allocateVertices(positions.data(), positionStride, count);
+  positionVertexOffset = static_cast<int32_t>(positionAllocation.offset / positionStride);
 }
 
-void LveModel::createIndexBuffers(const std::vector<uint32_t> &indices) {
-  indexCount = static_cast<uint32_t>(indices.size());
+void LveModel::createIndexBuffers(const void *indices, uint32_t count) {
+  indexCount = count;
   hasIndexBuffer = indexCount > 0;
 
   if (!hasIndexBuffer) {
     return;
   }
 
-  VkDeviceSize bufferSize = sizeof(indices[0]) * indexCount;
-  uint32_t indexSize = sizeof(indices[0]);
+  uint32_t indexSize = getIndexSize(indexType);
+  indexAllocation = geometryPool.allocateIndices(indices, indexSize, indexCount);
+  firstIndex = static_cast<uint32_t>(indexAllocation.offset / indexSize);
+}
+
+VkDeviceSize LveModel::relocate(VkCommandBuffer commandBuffer) {
+  VkDeviceSize moved = 0;
+  if (geometryPool.isEvacuating(vertexAllocation)) {
+    VkDeviceSize stride = vertexAllocation.size / vertexCount;
+    vertexAllocation = geometryPool.relocate(commandBuffer, vertexAllocation);
+    vertexOffset = static_cast<int32_t>(vertexAllocation.offset / stride);
+    moved += vertexAllocation.size;
+  }
+  if (geometryPool.isEvacuating(positionAllocation)) {
+    positionAllocation = geometryPool.relocate(commandBuffer, positionAllocation);
+    positionVertexOffset =
+        static_cast<int32_t>(positionAllocation.offset / getPositionStride(vertexFormat));
+    moved += positionAllocation.size;
+  }
+  if (geometryPool.isEvacuating(indexAllocation)) {
+    indexAllocation = geometryPool.relocate(commandBuffer, indexAllocation);
+    firstIndex = static_cast<uint32_t>(indexAllocation.offset / getIndexSize(indexType));
+    moved += indexAllocation.size;
+  }
+  return moved;
+}
+
+void LveModel::draw(VkCommandBuffer commandBuffer) { drawLod(commandBuffer, 0); }
 
-  LveBuffer stagingBuffer{
-      lveDevice,
-      indexSize,
-      indexCount,
-      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-  };
+void LveModel::drawLod(VkCommandBuffer commandBuffer, uint32_t lod, VertexStream stream) {
+  int32_t streamVertexOffset = getVertexOffset(stream);
+  if (hasIndexBuffer) {
+    const Lod &range = lods[std::min(lod, static_cast<uint32_t>(lods.size() - 1))];
+    vkCmdDrawIndexed(
+        commandBuffer,
+        range.indexCount,
+        1,
+        firstIndex + range.firstIndex,
+        streamVertexOffset,
+        0);
+  } else {
+    vkCmdDraw(commandBuffer, vertexCount, 1, static_cast<uint32_t>(streamVertexOffset), 0);
+  }
+}
 
-  stagingBuffer.map();
-  stagingBuffer.writeToBuffer((void *)indices.data());
+void LveModel::drawVisible(
+    VkCommandBuffer commandBuffer,
+    const LveClusterCullInfo &cullInfo,
+    uint32_t lod,
+    VertexStream stream) {
+  if (!cullInfo.isSphereVisible(getBoundsCenter(), getBoundsRadius())) {
+    return;
+  }
+  // only lod 0 is split into meshlets, the coarser levels are cheap enough to draw whole
+  if (lod > 0 || meshlets.empty() || !hasIndexBuffer) {
+    drawLod(commandBuffer, lod, stream);
+    return;
+  }
 
-  indexBuffer = std::make_unique<LveBuffer>(
-      lveDevice,
-      indexSize,
-      indexCount,
-      VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  int32_t streamVertexOffset = getVertexOffset(stream);
 
-  lveDevice.copyBuffer(stagingBuffer.getBuffer(), indexBuffer->getBuffer(), bufferSize);
+  // meshlets are stored back to back, so runs of visible ones collapse into one draw
+  uint32_t runFirstIndex = 0;
+  uint32_t runIndexCount = 0;
+  for (const auto &meshlet : meshlets) {
+    if (!cullInfo.isMeshletVisible(meshlet)) {
+      continue;
+    }
+    if (runIndexCount > 0 && runFirstIndex + runIndexCount == meshlet.firstIndex) {
+      runIndexCount += meshlet.indexCount;
+      continue;
+    }
+    if (runIndexCount > 0) {
+      vkCmdDrawIndexed(
+          commandBuffer, runIndexCount, 1, firstIndex + runFirstIndex, streamVertexOffset, 0);
+    }
+    runFirstIndex = meshlet.firstIndex;
+    runIndexCount = meshlet.indexCount;
+  }
+  if (runIndexCount > 0) {
+    vkCmdDrawIndexed(
+        commandBuffer, runIndexCount, 1, firstIndex + runFirstIndex, streamVertexOffset, 0);
+  }
 }
 
-void LveModel::draw(VkCommandBuffer commandBuffer) {
+void LveModel::bind(VkCommandBuffer commandBuffer, const LveModel *bound, VertexStream stream) {
+  assert(
+      (stream == VertexStream::Interleaved || hasPositionStream()) &&
+      "Model was built without a position stream");
+  VkBuffer vertexBuffer = geometryPool.getBuffer(getVertexAllocation(stream));
+  const LveGeometryPool::Allocation *boundVertices =
+      bound != nullptr ? &bound->getVertexAllocation(stream) : nullptr;
+  if (boundVertices == nullptr || !boundVertices->isValid() ||
+      bound->geometryPool.getBuffer(*boundVertices) != vertexBuffer) {
+    VkBuffer buffers[] = {vertexBuffer};
+    VkDeviceSize offsets[] = {0};
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+  }
+
   if (hasIndexBuffer) {
-    vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
-  } else {
-    vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+    // the whole block is bound, firstIndex picks the model out of it
+    VkBuffer indexBuffer = geometryPool.getBuffer(indexAllocation);
+    if (bound == nullptr || !bound->hasIndexBuffer || bound->indexType != indexType ||
+        bound->geometryPool.getBuffer(bound->indexAllocation) != indexBuffer) {
+      vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, indexType);
+    }
+  }
+}
+
+glm::mat4 LveModel::getDequantizationMatrix() const {
+  if (vertexFormat == VertexFormat::Float32) {
+    return glm::mat4{1.f};
   }
+  glm::mat4 dequantize = glm::translate(glm::mat4{1.f}, boundsMin);
+  return glm::scale(dequantize, boundsMax - boundsMin);
 }
 
-void LveModel::bind(VkCommandBuffer commandBuffer) {
-  VkBuffer buffers[] = {vertexBuffer->getBuffer()};
-  VkDeviceSize offsets[] = {0};
-  vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+uint32_t LveModel::getVertexStride(VertexFormat format) {
+  return format == VertexFormat::Float32 ? sizeof(Vertex) : sizeof(CompactVertex);
+}
 
-  if (hasIndexBuffer) {
-    vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+uint32_t LveModel::getIndexSize(VkIndexType indexType) {
+  return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+uint32_t LveModel::getPositionStride(VertexFormat format) {
+  return format == VertexFormat::Float32 ? sizeof(Vertex::position)
+                                         : sizeof(CompactVertex::position);
+}
+
+std::vector<VkVertexInputBindingDescription> LveModel::getPositionBindingDescriptions(
+    VertexFormat format) {
+  std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+  bindingDescriptions[0].binding = 0;
+  bindingDescriptions[0].stride = getPositionStride(format);
+  bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+  return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> LveModel::getPositionAttributeDescriptions(
+    VertexFormat format) {
+  VkFormat positionFormat = format == VertexFormat::Float32 ? VK_FORMAT_R32G32B32_SFLOAT
+                                                            : VK_FORMAT_R16G16B16A16_UNORM;
+  return {{0, 0, positionFormat, 0}};
+}
+
+std::vector<VkVertexInputBindingDescription> LveModel::getBindingDescriptions(
+    VertexFormat format) {
+  if (format == VertexFormat::Float32) {
+    return Vertex::getBindingDescriptions();
   }
+  std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+  bindingDescriptions[0].binding = 0;
+  bindingDescriptions[0].stride = sizeof(CompactVertex);
+  bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+  return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> LveModel::getAttributeDescriptions(
+    VertexFormat format) {
+  if (format == VertexFormat::Float32) {
+    return Vertex::getAttributeDescriptions();
+  }
+  // locations match simple_shader.vert, color (1) is not part of the compact layouts
+  VkFormat uvFormat =
+      format == VertexFormat::Compact ? VK_FORMAT_R16G16_UNORM : VK_FORMAT_R16G16_SFLOAT;
+  std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+  attributeDescriptions.push_back(
+      {0, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(CompactVertex, position)});
+  attributeDescriptions.push_back({2, 0, VK_FORMAT_R16G16_SNORM, offsetof(CompactVertex, normal)});
+  attributeDescriptions.push_back({3, 0, uvFormat, offsetof(CompactVertex, uv)});
+  return attributeDescriptions;
 }
 
 std::vector<VkVertexInputBindingDescription> LveModel::Vertex::getBindingDescriptions() {
@@ -141,59 +297,160 @@ std::vector<VkVertexInputAttributeDescription> LveModel::Vertex::getAttributeDes
 }
 
 void LveModel::Builder::loadModel(const std::string &filepath) {
-  tinyobj::attrib_t attrib;
-  std::vector<tinyobj::shape_t> shapes;
-  std::vector<tinyobj::material_t> materials;
-  std::string warn, err;
+  if (loadMeshCache(filepath, *this)) {
+    return;
+  }
+  loadObj(filepath);
+  writeMeshCache(filepath, *this);
+}
+
+void LveModel::Builder::computeBounds() {
+  boundsMin = glm::vec3{0.f};
+  boundsMax = glm::vec3{0.f};
+  if (vertices.empty()) {
+    return;
+  }
+  boundsMin = boundsMax = vertices[0].position;
+  for (const auto &vertex : vertices) {
+    boundsMin = glm::min(boundsMin, vertex.position);
+    boundsMax = glm::max(boundsMax, vertex.position);
+  }
+}
 
-  if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str())) {
-    throw std::runtime_error(warn + err);
+void LveModel::Builder::buildMeshlets() {
+  meshlets.clear();
+  if (vertices.empty() || indices.empty()) {
+    return;
   }
+  meshlets = lve::buildMeshlets(&vertices[0].position, sizeof(Vertex), vertices.size(), indices);
+}
+
+void LveModel::Builder::optimize() {
+  optimizeMeshletVertexCache(indices, meshlets, vertices.size());
+  if (!vertices.empty()) {
+    optimizeMeshletOverdraw(&vertices[0].position, sizeof(Vertex), indices, meshlets);
+  }
+
+  std::vector<uint32_t> remap = optimizeVertexFetch(indices, vertices.size());
+  std::vector<Vertex> fetchOrder(vertices.size());
+  size_t usedCount = 0;
+  for (size_t i = 0; i < vertices.size(); i++) {
+    if (remap[i] != ~0u) {
+      fetchOrder[remap[i]] = vertices[i];
+      usedCount++;
+    }
+  }
+  fetchOrder.resize(usedCount);
+  vertices = std::move(fetchOrder);
+}
+
+void LveModel::Builder::buildLods() {
+  lods.assign(1, Lod{0, static_cast<uint32_t>(indices.size()), 0.f});
+  if (!generateLodChain || vertices.empty() || indices.size() / 3 < kMinLodTriangles) {
+    return;
+  }
+
+  const size_t fullTriangleCount = indices.size() / 3;
+  const float maxError = kMaxLodError * glm::length(boundsMax - boundsMin);
+  LveMeshSimplifier simplifier{&vertices[0].position, sizeof(Vertex), vertices.size(), indices};
+  for (float ratio : kLodTriangleRatios) {
+    size_t targetIndexCount = static_cast<size_t>(fullTriangleCount * ratio) * 3;
+    float error = simplifier.simplify(targetIndexCount, maxError);
+    const auto &lodIndices = simplifier.getIndices();
+    // stuck on locked seams or the error bound, another level would barely save anything
+    if (lodIndices.size() > lods.back().indexCount * kMinLodReduction) {
+      break;
+    }
+    Lod lod{static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lodIndices.size()), error};
+    indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+    optimizeVertexCache(indices.data() + lod.firstIndex, lod.indexCount, vertices.size());
+    lods.push_back(lod);
+  }
+}
+
+void LveModel::Builder::loadObj(const std::string &filepath) {
+  LveObjData obj = parseObj(filepath);
 
   vertices.clear();
   indices.clear();
+  mappedFile.reset();
+  hasVertexColors = obj.hasVertexColors;
+  indices.reserve(obj.corners.size());
 
-  std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-  for (const auto &shape : shapes) {
-    for (const auto &index : shape.mesh.indices) {
-      Vertex vertex{};
-
-      if (index.vertex_index >= 0) {
-        vertex.position = {
-            attrib.vertices[3 * index.vertex_index + 0],
-            attrib.vertices[3 * index.vertex_index + 1],
-            attrib.vertices[3 * index.vertex_index + 2],
-        };
-
-        vertex.color = {
-            attrib.colors[3 * index.vertex_index + 0],
-            attrib.colors[3 * index.vertex_index + 1],
-            attrib.colors[3 * index.vertex_index + 2],
-        };
-      }
-
-      if (index.normal_index >= 0) {
-        vertex.normal = {
-            attrib.normals[3 * index.normal_index + 0],
-            attrib.normals[3 * index.normal_index + 1],
-            attrib.normals[3 * index.normal_index + 2],
-        };
-      }
-
-      if (index.texcoord_index >= 0) {
-        vertex.uv = {
-            attrib.texcoords[2 * index.texcoord_index + 0],
-            attrib.texcoords[2 * index.texcoord_index + 1],
-        };
-      }
-
-      if (uniqueVertices.count(vertex) == 0) {
-        uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-        vertices.push_back(vertex);
-      }
-      indices.push_back(uniqueVertices[vertex]);
+  LveDedupTable<Vertex> uniqueVertices{vertices, obj.corners.size()};
+  for (const auto &corner : obj.corners) {
+    Vertex vertex{};
+
+    vertex.position = obj.positions[corner.position];
+    vertex.color = obj.colors[corner.position];
+
+    if (corner.normal >= 0) {
+      vertex.normal = obj.normals[corner.normal];
+    }
+
+    if (corner.texCoord >= 0) {
+      vertex.uv = obj.texCoords[corner.texCoord];
     }
+
+    indices.push_back(uniqueVertices.insert(vertex));
+  }
+
+  buildMeshlets();
+  optimize();
+  computeBounds();
+  buildLods();
+  packVertices();
+  packIndices();
+}
+
+void LveModel::Builder::packVertices() {
+  packedVertices.clear();
+  if (!allowCompactFormat || hasVertexColors) {
+    vertexFormat = VertexFormat::Float32;
+    return;
+  }
+
+  bool uvsInUnitRange = true;
+  for (const auto &vertex : vertices) {
+    uvsInUnitRange &=
+        vertex.uv.x >= 0.f && vertex.uv.x <= 1.f && vertex.uv.y >= 0.f && vertex.uv.y <= 1.f;
+  }
+  vertexFormat = uvsInUnitRange ? VertexFormat::Compact : VertexFormat::CompactWrappedUv;
+
+  // flat meshes (quads) have a zero extent on one axis, keep the scale invertible
+  glm::vec3 extent = glm::max(boundsMax - boundsMin, glm::vec3{1e-6f});
+  boundsMax = boundsMin + extent;
+
+  packedVertices.resize(vertices.size() * sizeof(CompactVertex));
+  auto *packed = reinterpret_cast<CompactVertex *>(packedVertices.data());
+  for (size_t i = 0; i < vertices.size(); i++) {
+    const Vertex &vertex = vertices[i];
+    CompactVertex &out = packed[i];
+    glm::vec3 position = (vertex.position - boundsMin) / extent;
+    out.position[0] = floatToUnorm16(position.x);
+    out.position[1] = floatToUnorm16(position.y);
+    out.position[2] = floatToUnorm16(position.z);
+    out.position[3] = 0;
+    out.normal = octEncodeNormal(vertex.normal);
+    if (vertexFormat == VertexFormat::Compact) {
+      out.uv[0] = floatToUnorm16(vertex.uv.x);
+      out.uv[1] = floatToUnorm16(vertex.uv.y);
+    } else {
+      out.uv[0] = floatToHalf(vertex.uv.x);
+      out.uv[1] = floatToHalf(vertex.uv.y);
+    }
+  }
+}
+
+void LveModel::Builder::packIndices() {
+  packedIndices.clear();
+  indexType = VK_INDEX_TYPE_UINT32;
+  // primitive restart is never enabled, so 0xffff is an ordinary index
+  if (vertices.size() > std::numeric_limits<uint16_t>::max() + size_t{1}) {
+    return;
   }
+  indexType = VK_INDEX_TYPE_UINT16;
+  packedIndices.assign(indices.begin(), indices.end());
 }
 
 }  // namespace lve
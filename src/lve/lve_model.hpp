@@ -1,7 +1,9 @@
 #pragma once
 
-#include "lve/lve_buffer.hpp"
 #include "lve/lve_device.hpp"
+#include "lve/lve_geometry_pool.hpp"
+#include "lve/lve_mapped_file.hpp"
+#include "lve/lve_meshlet.hpp"
 
 // libs
 #define GLM_FORCE_RADIANS
@@ -15,6 +17,33 @@
 namespace lve {
 class LveModel {
  public:
+  enum class VertexFormat : uint32_t {
+    // 44 bytes, everything fp32, the only layout that keeps vertex colors
+    Float32 = 0,
+    // 16 bytes, see CompactVertex, for meshes whose uvs stay inside [0, 1]
+    Compact = 1,
+    // 16 bytes, like Compact but with half float uvs for meshes that tile their textures
+    CompactWrappedUv = 2,
+  };
+  static constexpr uint32_t kVertexFormatCount = 3;
+
+  // which vertex data a bind or draw uses
+  enum class VertexStream {
+    Interleaved,
+    // the de-interleaved positions, for depth only passes
+    Positions,
+  };
+
+  /**
+   * Quantized vertex used by the Compact formats. Positions are unorm16 relative to the mesh
+   * bounds, getDequantizationMatrix() maps them back to model space.
+   */
+  struct CompactVertex {
+    uint16_t position[4];  // xyz, w is padding
+    uint32_t normal;       // octahedral, 2x snorm16
+    uint16_t uv[2];        // unorm16 or half depending on the format
+  };
+
   struct Vertex {
     glm::vec3 position{};
     glm::vec3 color{};
@@ -30,36 +59,193 @@ class LveModel {
     }
   };
 
+  // a range of the shared index buffer, error is how far it strays from the full mesh
+  struct Lod {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;  // model space units
+  };
+
   struct Builder {
+    // full precision working copy, the GPU gets packedVertices unless the format is Float32
     std::vector<Vertex> vertices{};
     std::vector<uint32_t> indices{};
-
+    glm::vec3 boundsMin{};
+    glm::vec3 boundsMax{};
+    bool hasVertexColors = false;
+
+    // clear before loading to keep every mesh in Float32
+    bool allowCompactFormat = true;
+    VertexFormat vertexFormat = VertexFormat::Float32;
+    std::vector<uint8_t> packedVertices{};
+    // contiguous ranges of indices, see buildMeshlets()
+    std::vector<LveMeshlet> meshlets{};
+    // 16 bit copy of indices when every index fits, see packIndices()
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    std::vector<uint16_t> packedIndices{};
+    // lods[0] is the full mesh (the meshlets), the simplified levels follow it in indices
+    bool generateLodChain = true;
+    std::vector<Lod> lods{};
+    // upload a positions only copy of the vertices next to the interleaved ones
+    bool createPositionStream = true;
+
+    // set when the model came from a .lvemesh cache, vertices/indices stay empty and the
+    // geometry is read straight out of the mapping
+    std::shared_ptr<const LveMappedFile> mappedFile{};
+    const void *mappedVertices = nullptr;
+    uint32_t mappedVertexCount = 0;
+    const void *mappedIndices = nullptr;
+    uint32_t mappedIndexCount = 0;
+    const LveMeshlet *mappedMeshlets = nullptr;
+    uint32_t mappedMeshletCount = 0;
+    const Lod *mappedLods = nullptr;
+    uint32_t mappedLodCount = 0;
+
+    /**
+     * Loads a cooked .lvemesh if one is present and up to date, otherwise parses the OBJ and
+     * writes the cache for the next launch.
+     */
     void loadModel(const std::string &filepath);
+    void loadObj(const std::string &filepath);
+    void computeBounds();
+    // splits the mesh into clusters for culling, reorders indices
+    void buildMeshlets();
+    // reorders meshlet triangles for the vertex cache, meshlets against overdraw and vertices for
+    // fetch locality, run after buildMeshlets()
+    void optimize();
+    // appends simplified copies of the mesh to indices, needs the bounds
+    void buildLods();
+    // picks the smallest format that represents the mesh and fills packedVertices
+    void packVertices();
+    void packIndices();
+
+    const void *getVertexData() const {
+      if (mappedFile) return mappedVertices;
+      return vertexFormat == VertexFormat::Float32 ? static_cast<const void *>(vertices.data())
+                                                   : packedVertices.data();
+    }
+    uint32_t getVertexStride() const { return LveModel::getVertexStride(vertexFormat); }
+    uint32_t getVertexCount() const {
+      return mappedFile ? mappedVertexCount : static_cast<uint32_t>(vertices.size());
+    }
+    const void *getIndexData() const {
+      if (mappedFile) return mappedIndices;
+      return indexType == VK_INDEX_TYPE_UINT16 ? static_cast<const void *>(packedIndices.data())
+                                               : indices.data();
+    }
+    uint32_t getIndexSize() const { return LveModel::getIndexSize(indexType); }
+    uint32_t getIndexCount() const {
+      return mappedFile ? mappedIndexCount : static_cast<uint32_t>(indices.size());
+    }
+    const LveMeshlet *getMeshletData() const {
+      return mappedFile ? mappedMeshlets : meshlets.data();
+    }
+    uint32_t getMeshletCount() const {
+      return mappedFile ? mappedMeshletCount : static_cast<uint32_t>(meshlets.size());
+    }
+    const Lod *getLodData() const { return mappedFile ? mappedLods : lods.data(); }
+    uint32_t getLodCount() const {
+      return mappedFile ? mappedLodCount : static_cast<uint32_t>(lods.size());
+    }
   };
 
-  LveModel(LveDevice &device, const LveModel::Builder &builder);
+  // vertices and indices are sub-allocated from pool, which has to outlive the model
+  LveModel(LveGeometryPool &pool, const LveModel::Builder &builder);
   ~LveModel();
 
   LveModel(const LveModel &) = delete;
   LveModel &operator=(const LveModel &) = delete;
 
   static std::unique_ptr<LveModel> createModelFromFile(
-      LveDevice &device, const std::string &filepath);
-
-  void bind(VkCommandBuffer commandBuffer);
+      LveGeometryPool &pool, const std::string &filepath);
+
+  static uint32_t getVertexStride(VertexFormat format);
+  static uint32_t getIndexSize(VkIndexType indexType);
+  static std::vector<VkVertexInputBindingDescription> getBindingDescriptions(VertexFormat format);
+  static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(
+      VertexFormat format);
+  /**
+   * Layout of VertexStream::Positions, binding 0 and location 0 like the interleaved layout.
+   * Positions keep the encoding of the full vertex, so both streams transform bit-identically.
+   */
+  static uint32_t getPositionStride(VertexFormat format);
+  static std::vector<VkVertexInputBindingDescription> getPositionBindingDescriptions(
+      VertexFormat format);
+  static std::vector<VkVertexInputAttributeDescription> getPositionAttributeDescriptions(
+      VertexFormat format);
+
+  // skips the binds that the previously bound model already made, if it is passed in
+  void bind(
+      VkCommandBuffer commandBuffer,
+      const LveModel *bound = nullptr,
+      VertexStream stream = VertexStream::Interleaved);
+  // draws lod 0
   void draw(VkCommandBuffer commandBuffer);
+  void drawLod(
+      VkCommandBuffer commandBuffer,
+      uint32_t lod,
+      VertexStream stream = VertexStream::Interleaved);
+  /**
+   * Skips the model if its bounds fail cullInfo. At lod 0 only the meshlets that pass are drawn,
+   * neighbouring visible meshlets merged into a single draw.
+   */
+  void drawVisible(
+      VkCommandBuffer commandBuffer,
+      const LveClusterCullInfo &cullInfo,
+      uint32_t lod = 0,
+      VertexStream stream = VertexStream::Interleaved);
+
+  VertexFormat getVertexFormat() const { return vertexFormat; }
+  bool hasPositionStream() const { return positionAllocation.isValid(); }
+  glm::vec3 getBoundsMin() const { return boundsMin; }
+  glm::vec3 getBoundsMax() const { return boundsMax; }
+  glm::vec3 getBoundsCenter() const { return (boundsMin + boundsMax) * .5f; }
+  float getBoundsRadius() const { return glm::length(boundsMax - boundsMin) * .5f; }
+  const std::vector<LveMeshlet> &getMeshlets() const { return meshlets; }
+  const std::vector<Lod> &getLods() const { return lods; }
+
+  // model space transform of the stored positions, fold it into the model matrix when drawing
+  glm::mat4 getDequantizationMatrix() const;
+
+  /**
+   * Records copies of the geometry the pool is evacuating into blocks that stay, see
+   * LveGeometryPool::beginDefragmentation(). Draws recorded afterwards use the new ranges.
+   * Returns the bytes moved.
+   */
+  VkDeviceSize relocate(VkCommandBuffer commandBuffer);
 
  private:
-  void createVertexBuffers(const std::vector<Vertex> &vertices);
-  void createIndexBuffers(const std::vector<uint32_t> &indices);
-
-  LveDevice &lveDevice;
-
-  std::unique_ptr<LveBuffer> vertexBuffer;
+  void createVertexBuffers(const void *vertices, uint32_t stride, uint32_t count);
+  void createPositionBuffer(const void *vertices, uint32_t stride, uint32_t count);
+  const LveGeometryPool::Allocation &getVertexAllocation(VertexStream stream) const {
+    return stream == VertexStream::Positions ? positionAllocation : vertexAllocation;
+  }
+  int32_t getVertexOffset(VertexStream stream) const {
+    return stream == VertexStream::Positions ? positionVertexOffset : vertexOffset;
+  }
+  void createIndexBuffers(const void *indices, uint32_t count);
+
+  LveGeometryPool &geometryPool;
+
+  VertexFormat vertexFormat;
+  glm::vec3 boundsMin;
+  glm::vec3 boundsMax;
+
+  LveGeometryPool::Allocation vertexAllocation;
   uint32_t vertexCount;
+  // where the model starts in its block, in vertices and indices
+  int32_t vertexOffset = 0;
+  uint32_t firstIndex = 0;
+
+  LveGeometryPool::Allocation positionAllocation;
+  int32_t positionVertexOffset = 0;
 
   bool hasIndexBuffer = false;
-  std::unique_ptr<LveBuffer> indexBuffer;
+  VkIndexType indexType;
+  LveGeometryPool::Allocation indexAllocation;
   uint32_t indexCount;
+
+  std::vector<LveMeshlet> meshlets;
+  std::vector<Lod> lods;
 };
 }  // namespace lve
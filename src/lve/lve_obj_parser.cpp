@@ -0,0 +1,418 @@
+#include "lve_obj_parser.hpp"
+
+#include "lve_mapped_file.hpp"
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+
+namespace {
+
+// below this a chunk is not worth the scheduling overhead
+constexpr size_t kMinChunkSize = 256 * 1024;
+// out of reach of any resolved index, a relative one may be -1 until the merge adds the base
+constexpr int32_t kMissingIndex = INT32_MIN;
+
+constexpr double kPowersOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline const char *skipSpace(const char *p, const char *end) {
+  while (p < end && isSpace(*p)) p++;
+  return p;
+}
+
+// rare spellings (nan, inf, hex floats) go through strtod on a terminated copy
+bool parseFloatSlow(const char *&p, const char *end, float &out) {
+  char buffer[64];
+  size_t length = std::min(static_cast<size_t>(end - p), sizeof(buffer) - 1);
+  std::memcpy(buffer, p, length);
+  buffer[length] = '\0';
+  char *parsedEnd = nullptr;
+  double value = std::strtod(buffer, &parsedEnd);
+  if (parsedEnd == buffer) return false;
+  p += parsedEnd - buffer;
+  out = static_cast<float>(value);
+  return true;
+}
+
+/**
+ * Decimal to float without locale lookups or null terminated input. Up to 19 significant digits
+ * are accumulated in an integer and scaled once, which is exact enough for 32 bit floats.
+ */
+bool parseFloat(const char *&p, const char *end, float &out) {
+  p = skipSpace(p, end);
+  const char *start = p;
+
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    p++;
+  }
+
+  uint64_t mantissa = 0;
+  int significantDigits = 0;
+  int exponent = 0;
+  bool anyDigits = false;
+  for (; p < end && isDigit(*p); p++) {
+    anyDigits = true;
+    if (significantDigits < 19) {
+      mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+      if (mantissa) significantDigits++;
+    } else {
+      exponent++;
+    }
+  }
+  if (p < end && *p == '.') {
+    p++;
+    for (; p < end && isDigit(*p); p++) {
+      anyDigits = true;
+      if (significantDigits < 19) {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        if (mantissa) significantDigits++;
+        exponent--;
+      }
+    }
+  }
+  if (!anyDigits) {
+    p = start;
+    return parseFloatSlow(p, end, out);
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char *exponentStart = p++;
+    bool negativeExponent = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+      negativeExponent = *p == '-';
+      p++;
+    }
+    if (p < end && isDigit(*p)) {
+      int value = 0;
+      for (; p < end && isDigit(*p); p++) {
+        if (value < 10000) value = value * 10 + (*p - '0');
+      }
+      exponent += negativeExponent ? -value : value;
+    } else {
+      p = exponentStart;
+    }
+  }
+
+  double value = static_cast<double>(mantissa);
+  if (exponent < 0) {
+    value = -exponent <= 22 ? value / kPowersOfTen[-exponent] : value * std::pow(10.0, exponent);
+  } else if (exponent > 0) {
+    value = exponent <= 22 ? value * kPowersOfTen[exponent] : value * std::pow(10.0, exponent);
+  }
+  out = static_cast<float>(negative ? -value : value);
+  return true;
+}
+
+bool parseInt(const char *&p, const char *end, int32_t &out) {
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    p++;
+  }
+  if (p >= end || !isDigit(*p)) return false;
+  int64_t value = 0;
+  for (; p < end && isDigit(*p); p++) {
+    value = value * 10 + (*p - '0');
+    if (value > INT32_MAX) return false;
+  }
+  out = static_cast<int32_t>(negative ? -value : value);
+  return true;
+}
+
+struct Chunk {
+  const char *begin;
+  const char *end;
+
+  std::vector<glm::vec3> positions{};
+  std::vector<glm::vec3> colors{};
+  std::vector<glm::vec3> normals{};
+  std::vector<glm::vec2> texCoords{};
+  // polygon corners as written in the file, triangulated during the merge once positions from
+  // earlier chunks are available
+  std::vector<LveObjData::Corner> corners{};
+  std::vector<uint32_t> faceSizes{};
+  size_t triangleCorners = 0;
+  // negative OBJ indices count back from the current line, which may reach into earlier chunks.
+  // they are stored relative to this chunk's first element and listed here (corner * 3 + slot)
+  // so the merge can add the chunk base once the counts of all earlier chunks are known
+  std::vector<uint32_t> relativeSlots{};
+  bool hasColors = false;
+  std::string error{};
+};
+
+// turns a one based or negative OBJ index into a zero based one, see Chunk::relativeSlots
+bool resolveIndex(int32_t index, size_t localCount, int32_t &out, bool &relative) {
+  if (index > 0) {
+    out = index - 1;
+    relative = false;
+    return true;
+  }
+  if (index < 0) {
+    out = static_cast<int32_t>(localCount) + index;
+    relative = true;
+    return true;
+  }
+  return false;
+}
+
+bool parseFace(const char *p, const char *end, Chunk &chunk) {
+  // fixed storage covers the common triangle/quad case without touching the heap
+  LveObjData::Corner polygon[64];
+  bool relative[64][3];
+  uint32_t cornerCount = 0;
+
+  while (true) {
+    p = skipSpace(p, end);
+    if (p >= end) break;
+    if (cornerCount == 64) return false;
+
+    LveObjData::Corner &corner = polygon[cornerCount];
+    bool *isRelative = relative[cornerCount];
+    corner = {kMissingIndex, kMissingIndex, kMissingIndex};
+    isRelative[0] = isRelative[1] = isRelative[2] = false;
+
+    int32_t index;
+    if (!parseInt(p, end, index) ||
+        !resolveIndex(index, chunk.positions.size(), corner.position, isRelative[0])) {
+      return false;
+    }
+    if (p < end && *p == '/') {
+      p++;
+      if (p < end && *p != '/' && !isSpace(*p)) {
+        if (!parseInt(p, end, index) ||
+            !resolveIndex(index, chunk.texCoords.size(), corner.texCoord, isRelative[1])) {
+          return false;
+        }
+      }
+      if (p < end && *p == '/') {
+        p++;
+        if (!parseInt(p, end, index) ||
+            !resolveIndex(index, chunk.normals.size(), corner.normal, isRelative[2])) {
+          return false;
+        }
+      }
+    }
+    if (p < end && !isSpace(*p)) return false;
+    cornerCount++;
+  }
+  if (cornerCount < 3) return false;
+
+  uint32_t slot = static_cast<uint32_t>(chunk.corners.size()) * 3;
+  for (uint32_t i = 0; i < cornerCount; i++) {
+    for (uint32_t component = 0; component < 3; component++) {
+      if (relative[i][component]) chunk.relativeSlots.push_back(slot + i * 3 + component);
+    }
+    chunk.corners.push_back(polygon[i]);
+  }
+  chunk.faceSizes.push_back(cornerCount);
+  chunk.triangleCorners += (cornerCount - 2) * 3;
+  return true;
+}
+
+/**
+ * Quads are split along the shorter diagonal like tinyobj does, larger polygons are assumed to be
+ * convex and fanned from their first corner.
+ */
+void triangulate(
+    const std::vector<glm::vec3> &positions,
+    const LveObjData::Corner *polygon,
+    uint32_t cornerCount,
+    LveObjData::Corner *&out) {
+  if (cornerCount == 4) {
+    glm::vec3 diagonal02 = positions[polygon[2].position] - positions[polygon[0].position];
+    glm::vec3 diagonal13 = positions[polygon[3].position] - positions[polygon[1].position];
+    static constexpr uint32_t kSplit02[] = {0, 1, 2, 0, 2, 3};
+    static constexpr uint32_t kSplit13[] = {0, 1, 3, 1, 2, 3};
+    const uint32_t *order =
+        glm::dot(diagonal02, diagonal02) < glm::dot(diagonal13, diagonal13) ? kSplit02 : kSplit13;
+    for (uint32_t i = 0; i < 6; i++) *out++ = polygon[order[i]];
+    return;
+  }
+  for (uint32_t i = 1; i + 1 < cornerCount; i++) {
+    *out++ = polygon[0];
+    *out++ = polygon[i];
+    *out++ = polygon[i + 1];
+  }
+}
+
+void parseChunk(Chunk &chunk) {
+  const char *p = chunk.begin;
+  while (p < chunk.end) {
+    const char *lineEnd =
+        static_cast<const char *>(std::memchr(p, '\n', static_cast<size_t>(chunk.end - p)));
+    if (!lineEnd) lineEnd = chunk.end;
+
+    const char *token = skipSpace(p, lineEnd);
+    bool ok = true;
+    if (lineEnd - token >= 2 && token[0] == 'v' && isSpace(token[1])) {
+      token += 2;
+      float values[6]{};
+      int count = 0;
+      while (count < 6 && parseFloat(token, lineEnd, values[count])) count++;
+      ok = count >= 3;
+      chunk.positions.push_back({values[0], values[1], values[2]});
+      if (count == 6) {
+        chunk.colors.push_back({values[3], values[4], values[5]});
+        chunk.hasColors = true;
+      } else {
+        chunk.colors.push_back({1.f, 1.f, 1.f});
+      }
+    } else if (lineEnd - token >= 3 && token[0] == 'v' && token[1] == 'n' && isSpace(token[2])) {
+      token += 3;
+      glm::vec3 normal{};
+      ok = parseFloat(token, lineEnd, normal.x) && parseFloat(token, lineEnd, normal.y) &&
+           parseFloat(token, lineEnd, normal.z);
+      chunk.normals.push_back(normal);
+    } else if (lineEnd - token >= 3 && token[0] == 'v' && token[1] == 't' && isSpace(token[2])) {
+      token += 3;
+      glm::vec2 uv{};
+      ok = parseFloat(token, lineEnd, uv.x);
+      if (ok && !parseFloat(token, lineEnd, uv.y)) uv.y = 0.f;
+      chunk.texCoords.push_back(uv);
+    } else if (lineEnd - token >= 2 && token[0] == 'f' && isSpace(token[1])) {
+      ok = parseFace(token + 2, lineEnd, chunk);
+    }
+    // everything else (comments, o, g, s, usemtl, mtllib, lines, points) is ignored
+
+    if (!ok && chunk.error.empty()) {
+      chunk.error.assign(p, lineEnd);
+    }
+    p = lineEnd + 1;
+  }
+}
+
+std::vector<Chunk> splitChunks(const char *data, size_t size, uint32_t threadCount) {
+  size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount * 4, size / kMinChunkSize));
+  std::vector<Chunk> chunks;
+  chunks.reserve(chunkCount);
+
+  const char *end = data + size;
+  const char *begin = data;
+  for (size_t i = 1; i <= chunkCount && begin < end; i++) {
+    const char *split = i == chunkCount ? end : data + size * i / chunkCount;
+    if (split < begin) continue;
+    // move the split behind the next line break so no line is cut in half
+    const char *lineBreak =
+        static_cast<const char *>(std::memchr(split, '\n', static_cast<size_t>(end - split)));
+    split = lineBreak ? lineBreak + 1 : end;
+    Chunk chunk{};
+    chunk.begin = begin;
+    chunk.end = split;
+    chunks.push_back(std::move(chunk));
+    begin = split;
+  }
+  return chunks;
+}
+
+}  // namespace
+
+LveObjData parseObj(const std::string &filepath, LveThreadPool &pool) {
+  LveMappedFile file{filepath};
+  const char *data = reinterpret_cast<const char *>(file.data());
+
+  std::vector<Chunk> chunks = splitChunks(data, file.size(), pool.getThreadCount());
+  pool.parallelFor(chunks.size(), [&](size_t i) { parseChunk(chunks[i]); });
+
+  for (const auto &chunk : chunks) {
+    if (!chunk.error.empty()) {
+      throw std::runtime_error("failed to parse " + filepath + ": '" + chunk.error + "'");
+    }
+  }
+
+  // exclusive prefix sums give every chunk its offset into the merged streams
+  struct Offsets {
+    size_t positions, normals, texCoords, corners;
+  };
+  std::vector<Offsets> offsets(chunks.size() + 1);
+  offsets[0] = {0, 0, 0, 0};
+  bool hasColors = false;
+  for (size_t i = 0; i < chunks.size(); i++) {
+    offsets[i + 1] = {
+        offsets[i].positions + chunks[i].positions.size(),
+        offsets[i].normals + chunks[i].normals.size(),
+        offsets[i].texCoords + chunks[i].texCoords.size(),
+        offsets[i].corners + chunks[i].triangleCorners};
+    hasColors |= chunks[i].hasColors;
+  }
+  const Offsets &totals = offsets.back();
+
+  LveObjData obj{};
+  obj.hasVertexColors = hasColors;
+  obj.positions.resize(totals.positions);
+  obj.colors.resize(totals.positions);
+  obj.normals.resize(totals.normals);
+  obj.texCoords.resize(totals.texCoords);
+  obj.corners.resize(totals.corners);
+
+  std::atomic<bool> outOfRange{false};
+  pool.parallelFor(chunks.size(), [&](size_t i) {
+    Chunk &chunk = chunks[i];
+    const Offsets &base = offsets[i];
+    std::copy(
+        chunk.positions.begin(),
+        chunk.positions.end(),
+        obj.positions.begin() + base.positions);
+    std::copy(chunk.colors.begin(), chunk.colors.end(), obj.colors.begin() + base.positions);
+    std::copy(chunk.normals.begin(), chunk.normals.end(), obj.normals.begin() + base.normals);
+    std::copy(
+        chunk.texCoords.begin(),
+        chunk.texCoords.end(),
+        obj.texCoords.begin() + base.texCoords);
+
+    for (uint32_t slot : chunk.relativeSlots) {
+      auto &corner = chunk.corners[slot / 3];
+      switch (slot % 3) {
+        case 0:
+          corner.position += static_cast<int32_t>(base.positions);
+          break;
+        case 1:
+          corner.texCoord += static_cast<int32_t>(base.texCoords);
+          break;
+        default:
+          corner.normal += static_cast<int32_t>(base.normals);
+          break;
+      }
+    }
+
+    auto inRange = [](int32_t index, size_t count, bool optional) {
+      return (optional && index == kMissingIndex) ||
+             (index >= 0 && static_cast<size_t>(index) < count);
+    };
+    for (const auto &corner : chunk.corners) {
+      if (!inRange(corner.position, totals.positions, false) ||
+          !inRange(corner.texCoord, totals.texCoords, true) ||
+          !inRange(corner.normal, totals.normals, true)) {
+        outOfRange = true;
+        return;
+      }
+    }
+  });
+  if (outOfRange) {
+    throw std::runtime_error("failed to parse " + filepath + ": face index out of range");
+  }
+
+  // quads look at positions that may live in other chunks, so this waits for all copies above
+  pool.parallelFor(chunks.size(), [&](size_t i) {
+    LveObjData::Corner *out = obj.corners.data() + offsets[i].corners;
+    const LveObjData::Corner *polygon = chunks[i].corners.data();
+    for (uint32_t faceSize : chunks[i].faceSizes) {
+      triangulate(obj.positions, polygon, faceSize, out);
+      polygon += faceSize;
+    }
+  });
+  return obj;
+}
+
+}  // namespace lve
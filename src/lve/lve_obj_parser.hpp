@@ -0,0 +1,40 @@
+#pragma once
+
+#include "lve/lve_thread_pool.hpp"
+
+// libs
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+/**
+ * Raw attribute streams of a Wavefront OBJ file plus one corner per triangle vertex. Polygons are
+ * fan triangulated, corner indices are zero based and negative when the component is absent.
+ */
+struct LveObjData {
+  struct Corner {
+    int32_t position;
+    int32_t texCoord;
+    int32_t normal;
+  };
+
+  std::vector<glm::vec3> positions{};
+  std::vector<glm::vec3> colors{};  // one per position, white when the file has none
+  std::vector<glm::vec3> normals{};
+  std::vector<glm::vec2> texCoords{};
+  std::vector<Corner> corners{};
+  bool hasVertexColors = false;
+};
+
+/**
+ * Memory maps the file and parses it in line aligned chunks across the pool. Only geometry is
+ * read (v, vt, vn, f), materials and groups are ignored like the tinyobj path did.
+ */
+LveObjData parseObj(const std::string &filepath, LveThreadPool &pool = LveThreadPool::shared());
+
+}  // namespace lve
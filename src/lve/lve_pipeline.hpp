@@ -31,6 +31,7 @@ struct PipelineConfigInfo {
 
 class LvePipeline {
  public:
+  // an empty fragFilepath creates a vertex only pipeline, for depth only passes
   LvePipeline(
       LveDevice& device,
       const std::string& vertFilepath,
@@ -45,6 +46,12 @@ class LvePipeline {
 
   static void defaultPipelineConfigInfo(PipelineConfigInfo& configInfo);
   static void enableAlphaBlending(PipelineConfigInfo& configInfo);
+  // for depth pre-passes: depth writes only, the color attachment is left untouched
+  static void disableColorWrites(PipelineConfigInfo& configInfo);
+  // for passes after a depth pre-pass: only the front-most surface passes, depth stays as is
+  static void enableDepthEqualTest(PipelineConfigInfo& configInfo);
+  // for closed meshes wound counter-clockwise like OBJ, as seen through the y-down camera
+  static void enableBackFaceCulling(PipelineConfigInfo& configInfo);
 
  private:
   static std::vector<char> readFile(const std::string& filepath);
@@ -59,6 +66,6 @@ class LvePipeline {
   LveDevice& lveDevice;
   VkPipeline graphicsPipeline;
   VkShaderModule vertShaderModule;
-  VkShaderModule fragShaderModule;
+  VkShaderModule fragShaderModule = VK_NULL_HANDLE;
 };
 }  // namespace lve
@@ -0,0 +1,107 @@
+#include "lve_range_allocator.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace lve {
+
+LveRangeAllocator::LveRangeAllocator(uint64_t capacity) : capacity{capacity}, freeSize{capacity} {
+  if (capacity > 0) {
+    insertRange(0, capacity);
+  }
+}
+
+uint64_t LveRangeAllocator::allocate(uint64_t size, uint64_t alignment) {
+  assert(size > 0 && alignment > 0 && "Cannot allocate an empty range");
+  // anything at least size + alignment - 1 long fits, so the scan ends at the first such range
+  for (auto it = rangesBySize.lower_bound({size, 0}); it != rangesBySize.end(); ++it) {
+    uint64_t rangeSize = it->first;
+    uint64_t rangeOffset = it->second;
+    uint64_t offset = (rangeOffset + alignment - 1) / alignment * alignment;
+    uint64_t padding = offset - rangeOffset;
+    if (padding + size > rangeSize) continue;
+
+    // the padding in front stays free, whatever is left behind becomes a new free range
+    eraseRange(freeRanges.find(rangeOffset));
+    if (padding > 0) {
+      insertRange(rangeOffset, padding);
+    }
+    uint64_t tail = rangeSize - padding - size;
+    if (tail > 0) {
+      insertRange(offset + size, tail);
+    }
+    freeSize -= size;
+    return offset;
+  }
+  return kInvalidOffset;
+}
+
+void LveRangeAllocator::free(uint64_t offset, uint64_t size) {
+  assert(offset + size <= capacity && "Range is outside of the allocator");
+  freeSize += size;
+
+  auto next = freeRanges.lower_bound(offset);
+  assert((next == freeRanges.end() || offset + size <= next->first) && "Range is already free");
+  if (next != freeRanges.end() && offset + size == next->first) {
+    size += next->second;
+    auto merged = next++;
+    eraseRange(merged);
+  }
+  if (next != freeRanges.begin()) {
+    auto previous = std::prev(next);
+    assert(previous->first + previous->second <= offset && "Range is already free");
+    if (previous->first + previous->second == offset) {
+      offset = previous->first;
+      size += previous->second;
+      eraseRange(previous);
+    }
+  }
+  insertRange(offset, size);
+}
+
+uint64_t LveRangeAllocator::getLargestFreeRange() const {
+  return rangesBySize.empty() ? 0 : rangesBySize.rbegin()->first;
+}
+
+void LveRangeAllocator::insertRange(uint64_t offset, uint64_t size) {
+  freeRanges.emplace(offset, size);
+  rangesBySize.emplace(size, offset);
+}
+
+void LveRangeAllocator::eraseRange(std::map<uint64_t, uint64_t>::iterator range) {
+  rangesBySize.erase({range->second, range->first});
+  freeRanges.erase(range);
+}
+
+std::vector<size_t> selectAllocatorsToEvacuate(
+    const std::vector<const LveRangeAllocator *> &allocators, const std::vector<bool> &pinned) {
+  std::vector<size_t> order(allocators.size());
+  uint64_t totalFree = 0;
+  for (size_t i = 0; i < allocators.size(); i++) {
+    order[i] = i;
+    totalFree += allocators[i]->getFreeSize();
+  }
+  auto used = [&](size_t i) {
+    return allocators[i]->getCapacity() - allocators[i]->getFreeSize();
+  };
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return used(a) < used(b); });
+
+  std::vector<size_t> selected;
+  uint64_t movedSize = 0;
+  uint64_t remainingFree = totalFree;
+  for (size_t i : order) {
+    if (selected.size() + 1 >= allocators.size()) break;
+    if (used(i) > allocators[i]->getCapacity() / 2) break;
+    if (!pinned.empty() && pinned[i]) continue;
+    // what stays behind has to take everything moved out so far
+    if (movedSize + used(i) > remainingFree - allocators[i]->getFreeSize()) break;
+    movedSize += used(i);
+    remainingFree -= allocators[i]->getFreeSize();
+    selected.push_back(i);
+  }
+  return selected;
+}
+
+}  // namespace lve
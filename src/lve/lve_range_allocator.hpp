@@ -0,0 +1,60 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace lve {
+
+/**
+ * Free-list allocator for ranges of some larger resource (a buffer, a memory block). It only does
+ * the bookkeeping, callers map the returned offsets onto the resource themselves. Free ranges are
+ * indexed by offset and by size, so both allocate and free stay logarithmic with tens of
+ * thousands of live ranges.
+ */
+class LveRangeAllocator {
+ public:
+  static constexpr uint64_t kInvalidOffset = ~0ull;
+
+  explicit LveRangeAllocator(uint64_t capacity);
+
+  /**
+   * Best fit, the smallest free range that holds size bytes at the requested alignment. Returns
+   * kInvalidOffset if there is none. The alignment does not have to be a power of two.
+   */
+  uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+  // size has to match the allocation, neighbouring free ranges are merged
+  void free(uint64_t offset, uint64_t size);
+
+  uint64_t getCapacity() const { return capacity; }
+  uint64_t getFreeSize() const { return freeSize; }
+  uint64_t getLargestFreeRange() const;
+  bool isEmpty() const { return freeSize == capacity; }
+
+ private:
+  void insertRange(uint64_t offset, uint64_t size);
+  void eraseRange(std::map<uint64_t, uint64_t>::iterator range);
+
+  uint64_t capacity;
+  uint64_t freeSize;
+  // offset -> size, ordered by offset so a freed range finds its neighbours directly
+  std::map<uint64_t, uint64_t> freeRanges;
+  // the same ranges as (size, offset), for the best fit search
+  std::set<std::pair<uint64_t, uint64_t>> rangesBySize;
+};
+
+/**
+ * Defragmentation helper. Of allocators whose ranges can move between each other, returns the
+ * indices of the emptiest ones, none more than half full, whose used space fits into the free
+ * space the others keep. Leaves at least one allocator behind. Pinned allocators hold ranges that
+ * cannot move, they are never picked but still take what is moved out of the others.
+ */
+std::vector<size_t> selectAllocatorsToEvacuate(
+    const std::vector<const LveRangeAllocator *> &allocators,
+    const std::vector<bool> &pinned = {});
+
+}  // namespace lve
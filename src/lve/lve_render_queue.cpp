@@ -0,0 +1,71 @@
+#include "lve_render_queue.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace lve {
+
+namespace {
+
+constexpr uint32_t kPassBits = 4;
+constexpr uint32_t kPipelineBits = 8;
+constexpr uint32_t kMaterialBits = 16;
+constexpr uint32_t kMeshBits = 16;
+constexpr uint32_t kDepthBits = 20;
+static_assert(
+    kPassBits + kPipelineBits + kMaterialBits + kMeshBits + kDepthBits == 64,
+    "sort key fields fill 64 bits");
+
+uint64_t field(uint32_t value, uint32_t bits) {
+  return std::min<uint64_t>(value, (1ull << bits) - 1);
+}
+
+}  // namespace
+
+uint64_t LveRenderQueue::makeKey(
+    uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth) {
+  // positive floats compare like their bit patterns, the sign bit is dropped with negatives
+  uint32_t depthBits;
+  std::memcpy(&depthBits, &depth, sizeof(depthBits));
+  depthBits = depth > 0.f ? depthBits >> (32 - 1 - kDepthBits) : 0;
+
+  uint64_t key = field(pass, kPassBits);
+  key = key << kPipelineBits | field(pipeline, kPipelineBits);
+  key = key << kMaterialBits | field(material, kMaterialBits);
+  key = key << kMeshBits | field(mesh, kMeshBits);
+  key = key << kDepthBits | field(depthBits, kDepthBits);
+  return key;
+}
+
+void LveRenderQueue::sort() {
+  constexpr uint32_t kDigits = 8;
+  // histograms of all digits in one pass over the keys
+  std::array<std::array<uint32_t, 256>, kDigits> counts{};
+  for (const Packet &packet : packets) {
+    for (uint32_t digit = 0; digit < kDigits; digit++) {
+      counts[digit][(packet.key >> (digit * 8)) & 0xff]++;
+    }
+  }
+
+  scratch.resize(packets.size());
+  for (uint32_t digit = 0; digit < kDigits; digit++) {
+    auto &count = counts[digit];
+    // every key has the same byte here, nothing would move
+    if (std::find(count.begin(), count.end(), packets.size()) != count.end()) continue;
+
+    uint32_t offset = 0;
+    for (uint32_t &bucket : count) {
+      uint32_t size = bucket;
+      bucket = offset;
+      offset += size;
+    }
+    for (const Packet &packet : packets) {
+      scratch[count[(packet.key >> (digit * 8)) & 0xff]++] = packet;
+    }
+    packets.swap(scratch);
+  }
+}
+
+}  // namespace lve
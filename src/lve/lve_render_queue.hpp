@@ -0,0 +1,43 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+/**
+ * Draw packets ordered by a 64 bit sort key. A system submits one packet per draw, sorts, then
+ * replays the packets in key order, so draws sharing a pipeline, a texture and a mesh end up next
+ * to each other and state changes only happen between groups. From the most significant bit:
+ *
+ *   pass 4 | pipeline 8 | material 16 | mesh 16 | depth 20
+ *
+ * Depth is the top of the float's bit pattern, which orders non-negative distances front to back
+ * without knowing their range. Ids wider than their field are clamped, that only costs grouping.
+ */
+class LveRenderQueue {
+ public:
+  struct Packet {
+    uint64_t key;
+    // whatever the submitting system uses to find the draw again, typically an index
+    uint32_t item;
+  };
+
+  static uint64_t makeKey(
+      uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth);
+
+  void clear() { packets.clear(); }
+  void submit(uint64_t key, uint32_t item) { packets.push_back({key, item}); }
+  // stable LSD radix sort, 8 bits per pass, passes where every key has the same byte are skipped
+  void sort();
+
+  const std::vector<Packet> &getPackets() const { return packets; }
+
+ private:
+  std::vector<Packet> packets;
+  // second buffer of the radix sort, kept to avoid reallocating every frame
+  std::vector<Packet> scratch;
+};
+
+}  // namespace lve
@@ -20,6 +20,7 @@ class LveRenderer {
 
   VkRenderPass getSwapChainRenderPass() const { return lveSwapChain->getRenderPass(); }
   float getAspectRatio() const { return lveSwapChain->extentAspectRatio(); }
+  VkExtent2D getSwapChainExtent() const { return lveSwapChain->getSwapChainExtent(); }
   bool isFrameInProgress() const { return isFrameStarted; }
 
   VkCommandBuffer getCurrentCommandBuffer() const {
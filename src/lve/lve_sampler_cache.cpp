@@ -0,0 +1,72 @@
+#include "lve_sampler_cache.hpp"
+
+#include "lve_utils.hpp"
+
+// std
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+
+namespace {
+
+template <typename T>
+uint32_t asField(T value) {
+  static_assert(sizeof(T) == sizeof(uint32_t), "sampler key fields are 32 bits wide");
+  uint32_t field;
+  std::memcpy(&field, &value, sizeof(field));
+  return field;
+}
+
+}  // namespace
+
+LveSamplerCache::LveSamplerCache(LveDevice &device) : lveDevice{device} {}
+
+LveSamplerCache::~LveSamplerCache() {
+  for (auto &kv : samplers) {
+    vkDestroySampler(lveDevice.device(), kv.second, nullptr);
+  }
+}
+
+size_t LveSamplerCache::SamplerKeyHash::operator()(const SamplerKey &key) const {
+  return static_cast<size_t>(hashBytes(key.fields, sizeof(key.fields)));
+}
+
+LveSamplerCache::SamplerKey LveSamplerCache::makeKey(const VkSamplerCreateInfo &createInfo) {
+  return SamplerKey{{
+      asField(createInfo.flags),
+      asField(createInfo.magFilter),
+      asField(createInfo.minFilter),
+      asField(createInfo.mipmapMode),
+      asField(createInfo.addressModeU),
+      asField(createInfo.addressModeV),
+      asField(createInfo.addressModeW),
+      asField(createInfo.mipLodBias),
+      asField(createInfo.anisotropyEnable),
+      asField(createInfo.maxAnisotropy),
+      asField(createInfo.compareEnable),
+      asField(createInfo.compareOp),
+      asField(createInfo.minLod),
+      asField(createInfo.maxLod),
+      asField(createInfo.borderColor),
+      asField(createInfo.unnormalizedCoordinates),
+  }};
+}
+
+VkSampler LveSamplerCache::getSampler(const VkSamplerCreateInfo &createInfo) {
+  assert(createInfo.pNext == nullptr && "Sampler cache does not hash pNext chains");
+  SamplerKey key = makeKey(createInfo);
+  auto it = samplers.find(key);
+  if (it != samplers.end()) {
+    return it->second;
+  }
+
+  VkSampler sampler;
+  if (vkCreateSampler(lveDevice.device(), &createInfo, nullptr, &sampler) != VK_SUCCESS) {
+    throw std::runtime_error("failed to create sampler!");
+  }
+  samplers.emplace(key, sampler);
+  return sampler;
+}
+
+}  // namespace lve
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace lve {
+
+/**
+ * Hands out one VkSampler per distinct VkSamplerCreateInfo. The cache owns the samplers, so it has
+ * to outlive every texture that uses one.
+ */
+class LveSamplerCache {
+ public:
+  explicit LveSamplerCache(LveDevice &device);
+  ~LveSamplerCache();
+
+  LveSamplerCache(const LveSamplerCache &) = delete;
+  LveSamplerCache &operator=(const LveSamplerCache &) = delete;
+
+  // createInfo must not have a pNext chain
+  VkSampler getSampler(const VkSamplerCreateInfo &createInfo);
+  size_t getSamplerCount() const { return samplers.size(); }
+
+ private:
+  // every field of VkSamplerCreateInfo except sType and pNext, all 32 bits wide so no padding
+  struct SamplerKey {
+    uint32_t fields[16];
+
+    bool operator==(const SamplerKey &other) const {
+      return std::memcmp(fields, other.fields, sizeof(fields)) == 0;
+    }
+  };
+  struct SamplerKeyHash {
+    size_t operator()(const SamplerKey &key) const;
+  };
+
+  static SamplerKey makeKey(const VkSamplerCreateInfo &createInfo);
+
+  LveDevice &lveDevice;
+  std::unordered_map<SamplerKey, VkSampler, SamplerKeyHash> samplers;
+};
+
+}  // namespace lve
@@ -0,0 +1,54 @@
+#include "lve_source_stamp.hpp"
+
+#include "lve_mapped_file.hpp"
+#include "lve_utils.hpp"
+
+// std
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace lve {
+
+namespace {
+
+bool stampSizeAndTime(const std::string &sourcePath, LveSourceStamp &stamp) {
+  std::error_code ec;
+  auto size = fs::file_size(sourcePath, ec);
+  if (ec) return false;
+  auto modified = fs::last_write_time(sourcePath, ec);
+  if (ec) return false;
+  stamp.size = static_cast<uint64_t>(size);
+  stamp.modifiedTime = static_cast<int64_t>(modified.time_since_epoch().count());
+  return true;
+}
+
+uint64_t hashSource(const std::string &sourcePath) {
+  LveMappedFile source{sourcePath};
+  return hashBytes(source.data(), source.size());
+}
+
+}  // namespace
+
+bool stampSource(const std::string &sourcePath, LveSourceStamp &stamp) {
+  if (!stampSizeAndTime(sourcePath, stamp)) {
+    return false;
+  }
+  stamp.hash = hashSource(sourcePath);
+  return true;
+}
+
+bool isSourceUnchanged(const std::string &sourcePath, const LveSourceStamp &stamp) {
+  LveSourceStamp current;
+  if (!stampSizeAndTime(sourcePath, current)) {
+    // shipped without the source asset, the cooked file is all we have
+    return true;
+  }
+  if (current.size == stamp.size && current.modifiedTime == stamp.modifiedTime) {
+    return true;
+  }
+  // touched (checkout, copy) but possibly identical, only the contents decide
+  return current.size == stamp.size && hashSource(sourcePath) == stamp.hash;
+}
+
+}  // namespace lve
@@ -0,0 +1,28 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <string>
+
+namespace lve {
+
+/**
+ * Identifies the source a cooked file (.lvemesh, .lvetex) was built from, so a stale cache is
+ * noticed when the source changes.
+ */
+struct LveSourceStamp {
+  uint64_t size = 0;
+  int64_t modifiedTime = 0;
+  uint64_t hash = 0;
+};
+
+// fills all three fields, returns false if the source cannot be read
+bool stampSource(const std::string &sourcePath, LveSourceStamp &stamp);
+
+/**
+ * True if the source still matches stamp, or if it is missing altogether (shipped with only the
+ * cooked file). The contents are only hashed when size or mtime changed.
+ */
+bool isSourceUnchanged(const std::string &sourcePath, const LveSourceStamp &stamp);
+
+}  // namespace lve
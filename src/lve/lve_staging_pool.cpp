@@ -0,0 +1,59 @@
+#include "lve_staging_pool.hpp"
+
+// std
+#include <cassert>
+
+namespace lve {
+
+namespace {
+
+constexpr VkDeviceSize kRegionAlignment = 16;
+
+bool hasMemoryType(VkPhysicalDevice physicalDevice, VkMemoryPropertyFlags properties) {
+  VkPhysicalDeviceMemoryProperties memProperties;
+  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+  for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+    if ((memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+LveStagingPool::LveStagingPool(LveDevice &device, VkDeviceSize capacity) : ranges{capacity} {
+  VkMemoryPropertyFlags properties =
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  // without a cached type readbacks are slow but still correct
+  if (hasMemoryType(device.getPhysicalDevice(), properties | VK_MEMORY_PROPERTY_HOST_CACHED_BIT)) {
+    properties |= VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+  }
+  buffer = std::make_unique<LveBuffer>(
+      device, 1, static_cast<uint32_t>(capacity), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, properties);
+  buffer->map();
+}
+
+LveStagingPool::~LveStagingPool() {
+  assert(ranges.isEmpty() && "Staging regions must be released before the pool");
+}
+
+std::shared_ptr<uint8_t> LveStagingPool::allocate(VkDeviceSize size, VkDeviceSize &offset) {
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    offset = ranges.allocate(size, kRegionAlignment);
+  }
+  if (offset == LveRangeAllocator::kInvalidOffset) {
+    return nullptr;
+  }
+  uint8_t *mapped = static_cast<uint8_t *>(buffer->getMappedMemory()) + offset;
+  return std::shared_ptr<uint8_t>(
+      mapped, [this, offset, size](uint8_t *) { release(offset, size); });
+}
+
+void LveStagingPool::release(VkDeviceSize offset, VkDeviceSize size) {
+  std::lock_guard<std::mutex> lock{mutex};
+  ranges.free(offset, size);
+}
+
+}  // namespace lve
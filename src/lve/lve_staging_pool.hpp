@@ -0,0 +1,50 @@
+#pragma once
+
+#include "lve_buffer.hpp"
+#include "lve_device.hpp"
+#include "lve_range_allocator.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace lve {
+
+/**
+ * One persistently mapped, host visible buffer that loader threads write upload data into
+ * directly. Regions are handed out as shared pointers that return their range when the last
+ * reference goes away, so the data can be passed around like any heap allocation until the copy
+ * to the GPU is done.
+ *
+ * The memory is host cached when the device has such a type: workers read back what they wrote
+ * (the previous mip level, the .lvetex writer), which is very slow from write-combined memory.
+ */
+class LveStagingPool {
+ public:
+  LveStagingPool(LveDevice &device, VkDeviceSize capacity = 64 * 1024 * 1024);
+  // every region must have been released
+  ~LveStagingPool();
+
+  LveStagingPool(const LveStagingPool &) = delete;
+  LveStagingPool &operator=(const LveStagingPool &) = delete;
+
+  /**
+   * Thread safe. Returns nullptr when the pool has no room for size bytes right now, callers fall
+   * back to a heap allocation and a staging buffer of their own. Offsets are 16 byte aligned,
+   * enough for any texel block.
+   */
+  std::shared_ptr<uint8_t> allocate(VkDeviceSize size, VkDeviceSize &offset);
+
+  VkBuffer getBuffer() const { return buffer->getBuffer(); }
+  VkDeviceSize getCapacity() const { return ranges.getCapacity(); }
+
+ private:
+  void release(VkDeviceSize offset, VkDeviceSize size);
+
+  std::unique_ptr<LveBuffer> buffer;
+  std::mutex mutex;
+  LveRangeAllocator ranges;
+};
+
+}  // namespace lve
@@ -7,57 +7,224 @@
 #include "lve_device.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include "../external/stb/stb_image.hpp"
+#include "lve_bindless_textures.hpp"
 #include "lve_buffer.hpp"
-#include <stdexcept>
+#include "lve_texture_cache.hpp"
+#include "lve_texture_descriptor_cache.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
 
 namespace lve {
 Texture::Texture(LveDevice &device, const std::string &filepath) : lveDevice{device} {
+  //a context of its own, its destructor waits for the upload
+  LveUploadContext uploadContext{device, 0};
+  createImage(loadImage(filepath, device.supportsBlockCompression()), uploadContext);
+
+  VkSamplerCreateInfo samplerInfo = defaultSamplerInfo();
+  vkCreateSampler(lveDevice.device(), &samplerInfo, nullptr, &sampler);
+
+  createImageView();
+}
+
+Texture::Texture(LveDevice &device, const std::string &filepath, LveSamplerCache &samplerCache)
+    : lveDevice{device} {
+  LveUploadContext uploadContext{device, 0};
+  createImage(loadImage(filepath, device.supportsBlockCompression()), uploadContext);
+  sampler = samplerCache.getSampler(defaultSamplerInfo());
+  ownsSampler = false;
+  createImageView();
+}
+
+Texture::Texture(
+    LveDevice &device,
+    const ImageData &imageData,
+    LveSamplerCache &samplerCache,
+    LveUploadContext &uploadContext)
+    : lveDevice{device} {
+  createImage(imageData, uploadContext);
+  sampler = samplerCache.getSampler(defaultSamplerInfo());
+  ownsSampler = false;
+  createImageView();
+}
+
+size_t Texture::ImageData::getSize() const {
+  if (levels.empty()) {
+    return static_cast<size_t>(width) * height * 4;
+  }
+  return levels.back().offset + levels.back().size;
+}
+
+std::shared_ptr<uint8_t> Texture::allocatePixels(
+    ImageData &imageData, size_t size, LveStagingPool *stagingPool) {
+  imageData.stagingBuffer = VK_NULL_HANDLE;
+  imageData.stagingOffset = 0;
+  if (stagingPool != nullptr) {
+    VkDeviceSize offset;
+    std::shared_ptr<uint8_t> staged = stagingPool->allocate(size, offset);
+    if (staged != nullptr) {
+      imageData.stagingBuffer = stagingPool->getBuffer();
+      imageData.stagingOffset = offset;
+      return staged;
+    }
+  }
+  //pool full or none given, createImage stages it itself
+  return std::shared_ptr<uint8_t>{new uint8_t[size], std::default_delete<uint8_t[]>()};
+}
+
+Texture::ImageData Texture::loadImage(
+    const std::string &filepath, bool blockCompression, LveStagingPool *stagingPool) {
+  ImageData imageData{};
+  if (loadTextureCache(filepath, imageData, blockCompression)) {
+    if (stagingPool == nullptr) {
+      return imageData;
+    }
+    //straight from the mapping into staging memory, still on this thread
+    ImageData staged = imageData;
+    auto pixels = allocatePixels(staged, imageData.getSize(), stagingPool);
+    if (staged.stagingBuffer == VK_NULL_HANDLE) {
+      return imageData;
+    }
+    std::memcpy(pixels.get(), imageData.pixels.get(), imageData.getSize());
+    staged.pixels = std::move(pixels);
+    return staged;
+  }
+
   int channels;
-  int m_BytesPerPixel;
+  stbi_uc *data = stbi_load(filepath.c_str(), &imageData.width, &imageData.height, &channels, 4);
+  if (data == nullptr) {
+    throw std::runtime_error("failed to load texture image: " + filepath);
+  }
+  imageData.pixels = std::shared_ptr<uint8_t>(data, stbi_image_free);
+
+  //whichever chain gets uploaded is built right in staging memory
+  if (blockCompression) {
+    imageData = buildMipChain(imageData);
+    imageData = compressMipChain(imageData, chooseBlockFormat(imageData), stagingPool);
+  } else {
+    imageData = buildMipChain(imageData, stagingPool);
+  }
+  writeTextureCache(filepath, imageData);
+  return imageData;
+}
 
-  auto data = stbi_load(filepath.c_str(), &width, &height, &m_BytesPerPixel, 4);
+namespace {
 
-  mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+float srgbToLinear(float c) {
+  return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
 
-  LveBuffer stagingBuffer{
-      lveDevice,
-      4,
-      static_cast<uint32_t>(width * height),
-      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-  };
+uint8_t linearToSrgb(float c) {
+  c = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.f / 2.4f) - 0.055f;
+  return static_cast<uint8_t>(std::clamp(c, 0.f, 1.f) * 255.f + 0.5f);
+}
 
-  stagingBuffer.map();
-  stagingBuffer.writeToBuffer(data);
+}  // namespace
+
+Texture::ImageData Texture::buildMipChain(
+    const ImageData &imageData, LveStagingPool *stagingPool) {
+  assert(imageData.format == VK_FORMAT_R8G8B8A8_SRGB && "mip chains are built from srgb rgba8");
+
+  ImageData chain{};
+  chain.width = imageData.width;
+  chain.height = imageData.height;
+  chain.format = imageData.format;
+
+  uint32_t levelWidth = static_cast<uint32_t>(imageData.width);
+  uint32_t levelHeight = static_cast<uint32_t>(imageData.height);
+  size_t totalSize = 0;
+  while (true) {
+    size_t size = static_cast<size_t>(levelWidth) * levelHeight * 4;
+    chain.levels.push_back({levelWidth, levelHeight, totalSize, size});
+    totalSize += size;
+    if (levelWidth == 1 && levelHeight == 1) break;
+    levelWidth = std::max(levelWidth / 2, 1u);
+    levelHeight = std::max(levelHeight / 2, 1u);
+  }
 
-  imageFormat = VK_FORMAT_R8G8B8A8_SRGB;
+  std::shared_ptr<uint8_t> pixels = allocatePixels(chain, totalSize, stagingPool);
+  std::memcpy(pixels.get(), imageData.pixels.get(), chain.levels[0].size);
 
-  //IMAGE INFORMATION
-  VkImageCreateInfo imageInfo = {};
-  imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-  imageInfo.imageType = VK_IMAGE_TYPE_2D;
-  imageInfo.format = imageFormat;
-  imageInfo.mipLevels = mipLevels;
-  imageInfo.arrayLayers = 1;
-  imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-  imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-  imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-  imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-  imageInfo.extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
-  imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT; //flags
+  std::array<float, 256> toLinear;
+  for (int i = 0; i < 256; i++) {
+    toLinear[i] = srgbToLinear(i / 255.f);
+  }
 
+  //2x2 box filter of the previous level, colors are averaged in linear space so the smaller
+  //levels keep their brightness, alpha is linear already
+  for (size_t i = 1; i < chain.levels.size(); i++) {
+    const MipLevel &src = chain.levels[i - 1];
+    const MipLevel &dst = chain.levels[i];
+    const uint8_t *srcPixels = pixels.get() + src.offset;
+    uint8_t *dstPixels = pixels.get() + dst.offset;
+    for (uint32_t y = 0; y < dst.height; y++) {
+      //odd sizes drop the last row and column, like the blit did
+      size_t rowSize = static_cast<size_t>(src.width) * 4;
+      const uint8_t *row0 = srcPixels + std::min(2 * y, src.height - 1) * rowSize;
+      const uint8_t *row1 = srcPixels + std::min(2 * y + 1, src.height - 1) * rowSize;
+      for (uint32_t x = 0; x < dst.width; x++) {
+        size_t x0 = static_cast<size_t>(std::min(2 * x, src.width - 1)) * 4;
+        size_t x1 = static_cast<size_t>(std::min(2 * x + 1, src.width - 1)) * 4;
+        uint8_t *out = dstPixels + (static_cast<size_t>(y) * dst.width + x) * 4;
+        for (int c = 0; c < 3; c++) {
+          float sum = toLinear[row0[x0 + c]] + toLinear[row0[x1 + c]] + toLinear[row1[x0 + c]] +
+                      toLinear[row1[x1 + c]];
+          out[c] = linearToSrgb(sum * 0.25f);
+        }
+        int alphaSum = row0[x0 + 3] + row0[x1 + 3] + row1[x0 + 3] + row1[x1 + 3];
+        out[3] = static_cast<uint8_t>((alphaSum + 2) / 4);
+      }
+    }
+  }
 
-  //create and allocate gpu memory
-  lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory);
+  chain.pixels = std::move(pixels);
+  return chain;
+}
 
-  transitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+LveBlockFormat Texture::chooseBlockFormat(const ImageData &imageData) {
+  const uint8_t *pixels = imageData.pixels.get();
+  size_t texelCount = static_cast<size_t>(imageData.width) * imageData.height;
+  for (size_t i = 0; i < texelCount; i++) {
+    if (pixels[i * 4 + 3] != 255) {
+      return LveBlockFormat::BC7;
+    }
+  }
+  return LveBlockFormat::BC1;
+}
 
-  //to gpu image
-  lveDevice.copyBufferToImage(stagingBuffer.getBuffer(), image, static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1);
+Texture::ImageData Texture::compressMipChain(
+    const ImageData &chain, LveBlockFormat format, LveStagingPool *stagingPool) {
+  assert(!chain.levels.empty() && !isBlockCompressed(chain.format) && "expected an rgba8 mip chain");
 
-  generateMipmaps(); //create smaller versions of texture for distant rendering
-  imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  ImageData compressed{};
+  compressed.width = chain.width;
+  compressed.height = chain.height;
+  compressed.format = getBlockVkFormat(format, chain.format == VK_FORMAT_R8G8B8A8_SRGB);
+
+  size_t totalSize = 0;
+  for (const auto &level : chain.levels) {
+    size_t size = getImageLevelSize(compressed.format, level.width, level.height);
+    compressed.levels.push_back({level.width, level.height, totalSize, size});
+    totalSize += size;
+  }
 
+  std::shared_ptr<uint8_t> blocks = allocatePixels(compressed, totalSize, stagingPool);
+  for (size_t i = 0; i < chain.levels.size(); i++) {
+    const MipLevel &level = chain.levels[i];
+    compressImage(
+        format,
+        chain.pixels.get() + level.offset,
+        level.width,
+        level.height,
+        blocks.get() + compressed.levels[i].offset);
+  }
+  compressed.pixels = std::move(blocks);
+  return compressed;
+}
+
+VkSamplerCreateInfo Texture::defaultSamplerInfo() {
   //sampler info defines how texture is read, filtering, wrapping
   VkSamplerCreateInfo samplerInfo{};
   samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -70,13 +237,168 @@ Texture::Texture(LveDevice &device, const std::string &filepath) : lveDevice{dev
   samplerInfo.mipLodBias = 0.0f;
   samplerInfo.compareOp = VK_COMPARE_OP_NEVER;
   samplerInfo.minLod = 0.0f;
-  samplerInfo.maxLod = static_cast<float>(mipLevels);
+  //no upper clamp, the image view limits the levels so one sampler fits every texture size
+  samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
   samplerInfo.maxAnisotropy = 4.0;
   samplerInfo.anisotropyEnable = VK_TRUE;
   samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+  return samplerInfo;
+}
 
-  vkCreateSampler(lveDevice.device(), &samplerInfo, nullptr, &sampler);
+void Texture::createImage(const ImageData &sourceData, LveUploadContext &uploadContext) {
+  //uploads may run on a transfer queue, which cannot blit, so a missing chain is built on the cpu
+  ImageData builtChain;
+  if (sourceData.levels.empty()) {
+    builtChain = buildMipChain(sourceData);
+  }
+  const ImageData &imageData = sourceData.levels.empty() ? builtChain : sourceData;
+
+  width = imageData.width;
+  height = imageData.height;
+  mipLevels = static_cast<int>(imageData.levels.size());
+
+  //pixels a loader thread already put into a staging pool are copied from there, the pool gets
+  //them back once the upload ran
+  VkBuffer stagingBuffer = imageData.stagingBuffer;
+  VkDeviceSize stagingOffset = imageData.stagingOffset;
+  if (stagingBuffer != VK_NULL_HANDLE) {
+    uploadContext.keepAlive(imageData.pixels);
+  } else {
+    LveUploadContext::StagingRegion staging = uploadContext.allocateStaging(imageData.getSize());
+    std::memcpy(staging.mapped, imageData.pixels.get(), imageData.getSize());
+    stagingBuffer = staging.buffer;
+    stagingOffset = staging.offset;
+  }
+
+  imageFormat = imageData.format;
 
+  VkImageCreateInfo imageInfo = getImageInfo();
+
+  //create and allocate gpu memory
+  lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory);
+
+  //recorded into the context's batch, nothing here waits for the gpu
+  VkCommandBuffer commandBuffer = uploadContext.getCommandBuffer();
+  transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+  //to gpu image
+  copyMipLevels(commandBuffer, stagingBuffer, stagingOffset, imageData.levels);
+  //to SHADER_READ_ONLY_OPTIMAL, and over to the graphics queue if the copy ran elsewhere
+  uploadContext.finishImageUpload(image, static_cast<uint32_t>(mipLevels));
+  imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
+
+VkImageCreateInfo Texture::getImageInfo() const {
+  VkImageCreateInfo imageInfo = {};
+  imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+  imageInfo.imageType = VK_IMAGE_TYPE_2D;
+  imageInfo.format = imageFormat;
+  imageInfo.mipLevels = mipLevels;
+  imageInfo.arrayLayers = 1;
+  imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+  imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+  imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  imageInfo.extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
+  //transfer src so defragmentation can copy the image out again
+  imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                    VK_IMAGE_USAGE_SAMPLED_BIT;
+  return imageInfo;
+}
+
+VkDeviceSize Texture::relocate(VkCommandBuffer commandBuffer) {
+  if (!lveDevice.getAllocator().isEvacuating(imageMemory)) {
+    return 0;
+  }
+  assert(retiredImage == VK_NULL_HANDLE && "Texture relocated twice in one pass");
+
+  //allocates outside the evacuated blocks, they take nothing new
+  VkImage newImage;
+  LveAllocation newImageMemory;
+  lveDevice.createImageWithInfo(
+      getImageInfo(), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, newImage, newImageMemory);
+
+  transitionImageLayout(
+      commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+  retiredImage = image;
+  retiredImageView = imageView;
+  retiredImageMemory = imageMemory;
+  image = newImage;
+  imageMemory = newImageMemory;
+  transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+  //every level as is, no filtering involved
+  std::vector<VkImageCopy> regions(mipLevels);
+  for (int i = 0; i < mipLevels; i++) {
+    VkImageCopy &region = regions[i];
+    region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, static_cast<uint32_t>(i), 0, 1};
+    region.srcOffset = {0, 0, 0};
+    region.dstSubresource = region.srcSubresource;
+    region.dstOffset = {0, 0, 0};
+    region.extent = {
+        std::max(static_cast<uint32_t>(width) >> i, 1u),
+        std::max(static_cast<uint32_t>(height) >> i, 1u),
+        1};
+  }
+  vkCmdCopyImage(
+      commandBuffer,
+      retiredImage,
+      VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+      image,
+      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      static_cast<uint32_t>(regions.size()),
+      regions.data());
+
+  transitionImageLayout(
+      commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  createImageView();
+  //draws recorded from now on sample the new image, frames in flight keep their old element
+  if (bindlessTextures != nullptr) {
+    bindlessTextures->update(*this);
+  }
+  return imageMemory.size;
+}
+
+void Texture::finishRelocation() {
+  if (retiredImage == VK_NULL_HANDLE) {
+    return;
+  }
+  vkDestroyImageView(lveDevice.device(), retiredImageView, nullptr);
+  vkDestroyImage(lveDevice.device(), retiredImage, nullptr);
+  lveDevice.getAllocator().free(retiredImageMemory);
+  retiredImage = VK_NULL_HANDLE;
+  retiredImageView = VK_NULL_HANDLE;
+}
+
+void Texture::copyMipLevels(
+    VkCommandBuffer commandBuffer,
+    VkBuffer buffer,
+    VkDeviceSize bufferOffset,
+    const std::vector<MipLevel> &levels) {
+  std::vector<VkBufferImageCopy> regions(levels.size());
+  for (size_t i = 0; i < levels.size(); i++) {
+    VkBufferImageCopy &region = regions[i];
+    region.bufferOffset = bufferOffset + levels[i].offset;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = static_cast<uint32_t>(i);
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {levels[i].width, levels[i].height, 1};
+  }
+
+  vkCmdCopyBufferToImage(
+      commandBuffer,
+      buffer,
+      image,
+      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      static_cast<uint32_t>(regions.size()),
+      regions.data());
+}
+
+void Texture::createImageView() {
   //image view is how shaders access the image
   VkImageViewCreateInfo imageViewInfo {};
   imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -91,15 +413,22 @@ Texture::Texture(LveDevice &device, const std::string &filepath) : lveDevice{dev
   imageViewInfo.image = image;
 
   vkCreateImageView(lveDevice.device(), &imageViewInfo, nullptr, &imageView);
-
-  stbi_image_free(data); // free cpu memory
 }
 
 Texture::~Texture() { //cleanup all vulkan resources
+  if (descriptorCache != nullptr) {
+    descriptorCache->invalidate(this);
+  }
+  if (bindlessTextures != nullptr) {
+    bindlessTextures->release(*this);
+  }
+  finishRelocation();
   vkDestroyImage(lveDevice.device(), image, nullptr);
-  vkFreeMemory(lveDevice.device(), imageMemory, nullptr);
+  lveDevice.getAllocator().free(imageMemory);
   vkDestroyImageView(lveDevice.device(), imageView, nullptr);
-  vkDestroySampler(lveDevice.device(), sampler, nullptr);
+  if (ownsSampler) {
+    vkDestroySampler(lveDevice.device(), sampler, nullptr);
+  }
 }
 
 /**
@@ -107,9 +436,8 @@ Texture::~Texture() { //cleanup all vulkan resources
  * @param oldLayout
  * @param newLayout
  */
-void Texture::transitionImageLayout(VkImageLayout oldLayout, VkImageLayout newLayout) {
-  VkCommandBuffer commandBuffer = lveDevice.beginSingleTimeCommands();
-
+void Texture::transitionImageLayout(
+    VkCommandBuffer commandBuffer, VkImageLayout oldLayout, VkImageLayout newLayout) {
   //creates the memory barrier to synchronize the transition
   VkImageMemoryBarrier barrier{};
   barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -143,89 +471,19 @@ void Texture::transitionImageLayout(VkImageLayout oldLayout, VkImageLayout newLa
     sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
     destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
   }
+  //defragmentation copying the image out, after whatever sampled it last
+  else if (oldLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    sourceStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+  }
   else {
     throw std::runtime_error("unsupported layout transition!");
   }
 
   //submit barrier command
   vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-//execute and wait for completion
-  lveDevice.endSingleTimeCommands(commandBuffer);
-}
-//create smaller versions of the texture for efficient rendering
-//creates new image data
-//this helped because it was flickering at a distance but not since piecing it
-void Texture::generateMipmaps() {
-  VkFormatProperties formatProperties;
-  vkGetPhysicalDeviceFormatProperties(lveDevice.getPhysicalDevice(), imageFormat, &formatProperties);
-
-  if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
-    throw std::runtime_error("texture image format does not support linear blitting!");
-  }
-
-  VkCommandBuffer commandBuffer = lveDevice.beginSingleTimeCommands();
-
-  //barrier for transitioning mip levels
-  VkImageMemoryBarrier barrier{};
-  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-  barrier.image = image;
-  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  barrier.subresourceRange.baseArrayLayer = 0;
-  barrier.subresourceRange.layerCount = 1;
-  barrier.subresourceRange.levelCount = 1;
-
-  //dimensions for each level
-  int32_t mipWidth = width;
-  int32_t mipHeight = height;
-
-  //generate each level by blitting from the previous one
-  for (uint32_t i = 1; i < mipLevels; i++) {
-    barrier.subresourceRange.baseMipLevel = i - 1;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-    VkImageBlit blit{};
-    blit.srcOffsets[0] = {0, 0, 0};
-    blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
-    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    blit.srcSubresource.mipLevel = i - 1; // might be i
-    blit.srcSubresource.baseArrayLayer = 0;
-    blit.srcSubresource.layerCount = 1;
-    blit.dstOffsets[0] = {0, 0, 0};
-    blit.dstOffsets[1] = { mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1 };
-    blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    blit.dstSubresource.mipLevel = i;
-    blit.dstSubresource.baseArrayLayer = 0;
-    blit.dstSubresource.layerCount = 1;
-    // Perform the blit with linear filtering (smooth downsampling)
-    vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
-
-    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-    // Halve dimensions for next iteration
-    if (mipWidth > 1) mipWidth /= 2;
-    if (mipHeight > 1) mipHeight /= 2;
-  }
-
-  //last level is only written for transition to shader read only
-  barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-  barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-  lveDevice.endSingleTimeCommands(commandBuffer);
 }
 }
\ No newline at end of file
@@ -4,13 +4,69 @@
 
 #pragma once
 
+#include "lve_block_compression.hpp"
 #include "lve_device.hpp"
+#include "lve_sampler_cache.hpp"
+#include "lve_staging_pool.hpp"
+#include "lve_upload_context.hpp"
 #include <string.h>
 #include <vulkan/vulkan_core.h>
 
+// std
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace lve {
+class LveBindlessTextures;
+class LveTextureDescriptorCache;
+
 class Texture {
  public:
+  //one level of a precomputed mip chain, offset is relative to ImageData::pixels
+  struct MipLevel {
+    uint32_t width;
+    uint32_t height;
+    size_t offset;
+    size_t size;
+  };
+
+  //decoded pixels, no vulkan involved so it can be produced on any thread
+  struct ImageData {
+    int width = 0;
+    int height = 0;
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    //heap, stb or a mapped .lvetex, whatever keeps the bytes alive
+    std::shared_ptr<const uint8_t> pixels;
+    //empty means pixels is just level 0 and the gpu blits the rest of the chain
+    std::vector<MipLevel> levels;
+    //set when pixels live in a LveStagingPool, the upload then copies from there without a memcpy
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceSize stagingOffset = 0;
+
+    size_t getSize() const;
+  };
+
+  /**
+   * loads a cooked .lvetex if one is present and up to date, otherwise decodes the image,
+   * builds its mip chain and writes the .lvetex for the next launch. throws if nothing can be read
+   * @param blockCompression cook to BC1/BC7 instead of rgba8, only if the device can sample them
+   * @param stagingPool if given, the uploaded pixels are written there instead of the heap
+   */
+  static ImageData loadImage(
+      const std::string &filepath,
+      bool blockCompression = false,
+      LveStagingPool *stagingPool = nullptr);
+  //replaces an rgba8 srgb level 0 with the full chain, filtered in linear space
+  static ImageData buildMipChain(
+      const ImageData &imageData, LveStagingPool *stagingPool = nullptr);
+  //BC1 for opaque color, BC7 when any texel is translucent
+  static LveBlockFormat chooseBlockFormat(const ImageData &imageData);
+  //encodes every level of an rgba8 chain, srgb stays srgb where the format has a srgb variant
+  static ImageData compressMipChain(
+      const ImageData &chain, LveBlockFormat format, LveStagingPool *stagingPool = nullptr);
+
   /**
    * encapsulates a complete texture resource
    * like image data, sampler, and view
@@ -18,8 +74,25 @@ class Texture {
    * @param filepath filepath Path to the image file (jpg, png, etc)
    */
   Texture(LveDevice &device, const std::string &filepath);
+  /**
+   * same as above but shares a sampler from samplerCache instead of creating its own,
+   * the cache has to outlive the texture
+   */
+  Texture(LveDevice &device, const std::string &filepath, LveSamplerCache &samplerCache);
+  /**
+   * uploads already decoded pixels, the gpu half of the constructors above. the upload is only
+   * recorded into uploadContext, submitting it is up to the caller
+   */
+  Texture(
+      LveDevice &device,
+      const ImageData &imageData,
+      LveSamplerCache &samplerCache,
+      LveUploadContext &uploadContext);
   ~Texture();
 
+  //linear filtering, repeat wrapping and 4x anisotropy for every mip level
+  static VkSamplerCreateInfo defaultSamplerInfo();
+
   //delete copy constructors since they shouldn't be copied
   Texture(const Texture &) = delete;
   Texture &operator=(const Texture &) = delete;
@@ -30,21 +103,56 @@ class Texture {
   VkSampler getSampler() { return sampler; }  //used for texture filtering and wrapping modes
   VkImageView getImageView() { return imageView; } // used to access the image in shaders
   VkImageLayout getImageLayout() { return imageLayout; }  // important for synchronization and pipeline barriers
+  const LveAllocation &getImageMemory() const { return imageMemory; }  //what relocate moves
+
+  /**
+   * if the allocator is evacuating the image's memory, records a copy into a fresh image and
+   * switches over to it, returns the bytes moved. the old image lives on until finishRelocation,
+   * which may only run once the gpu is done with it
+   */
+  VkDeviceSize relocate(VkCommandBuffer commandBuffer);
+  void finishRelocation();
  private:
+  //same image every time, so a relocated copy matches the original
+  VkImageCreateInfo getImageInfo() const;
+  //uploads the pixels into a device local image with a full mip chain
+  void createImage(const ImageData &sourceData, LveUploadContext &uploadContext);
+  //one copy region per level, the image must be in TRANSFER_DST_OPTIMAL
+  void copyMipLevels(
+      VkCommandBuffer commandBuffer,
+      VkBuffer buffer,
+      VkDeviceSize bufferOffset,
+      const std::vector<MipLevel> &levels);
+  //size bytes from stagingPool if it has room, else from the heap, records where in imageData
+  static std::shared_ptr<uint8_t> allocatePixels(
+      ImageData &imageData, size_t size, LveStagingPool *stagingPool);
+  void createImageView();
   //transition from current to desired layout of  the image
-  void transitionImageLayout(VkImageLayout oldLayout, VkImageLayout newLayout);
-  //improve texture quality at different distances
-  // uses linear filtering to downsample each level
-  void generateMipmaps();
+  void transitionImageLayout(
+      VkCommandBuffer commandBuffer, VkImageLayout oldLayout, VkImageLayout newLayout);
 
   int width, height, mipLevels; //w&h in pixels
 
   LveDevice& lveDevice;       //refrence
   VkImage image;              //
-  VkDeviceMemory imageMemory; // memory for image
+  LveAllocation imageMemory; // memory for image, sub-allocated
   VkImageView imageView;      //view int the image for shader access
   VkSampler sampler;          //defining how to read the texture
+  bool ownsSampler = true;    //false when the sampler belongs to a LveSamplerCache
   VkFormat imageFormat;       //in pixels
   VkImageLayout imageLayout;  //current layout
+
+  //what relocate moved away from, until finishRelocation
+  VkImage retiredImage = VK_NULL_HANDLE;
+  VkImageView retiredImageView = VK_NULL_HANDLE;
+  LveAllocation retiredImageMemory;
+
+  //set by the cache that holds a descriptor set for this texture, told when the texture goes away
+  LveTextureDescriptorCache *descriptorCache = nullptr;
+  //the same for the bindless array, along with the element this texture occupies
+  LveBindlessTextures *bindlessTextures = nullptr;
+  uint32_t bindlessIndex = ~0u;
+  friend class LveBindlessTextures;
+  friend class LveTextureDescriptorCache;
 };
 }
\ No newline at end of file
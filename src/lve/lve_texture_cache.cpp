@@ -0,0 +1,204 @@
+#include "lve_texture_cache.hpp"
+
+#include "lve_block_compression.hpp"
+#include "lve_mapped_file.hpp"
+#include "lve_source_stamp.hpp"
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace lve {
+
+namespace {
+
+constexpr const char *kCacheExtension = ".lvetex";
+
+static_assert(sizeof(LveTextureFileHeader) == 64, "LveTextureFileHeader must not contain padding");
+static_assert(sizeof(LveTextureFileLevel) == 24, "LveTextureFileLevel must not contain padding");
+
+uint64_t alignOffset(uint64_t offset) {
+  return (offset + LveTextureFileHeader::kSectionAlignment - 1) &
+         ~(LveTextureFileHeader::kSectionAlignment - 1);
+}
+
+bool isCacheFile(const std::string &path) { return fs::path(path).extension() == kCacheExtension; }
+
+bool isHeaderValid(const LveTextureFileHeader &header, size_t fileSize) {
+  if (header.magic != LveTextureFileHeader::kMagic ||
+      header.version != LveTextureFileHeader::kVersion || header.width == 0 ||
+      header.height == 0 || header.mipLevels == 0 || header.mipLevels > 32 ||
+      getImageLevelSize(static_cast<VkFormat>(header.format), 1, 1) == 0) {
+    return false;
+  }
+  uint64_t levelTableEnd =
+      sizeof(LveTextureFileHeader) + header.mipLevels * sizeof(LveTextureFileLevel);
+  return header.dataOffset % LveTextureFileHeader::kSectionAlignment == 0 &&
+         header.dataOffset >= levelTableEnd && header.dataOffset + header.dataSize <= fileSize;
+}
+
+bool isLevelValid(
+    const LveTextureFileHeader &header, const LveTextureFileLevel &level, uint32_t mipLevel) {
+  return level.width == std::max(header.width >> mipLevel, 1u) &&
+         level.height == std::max(header.height >> mipLevel, 1u) &&
+         level.offset % LveTextureFileHeader::kSectionAlignment == 0 &&
+         level.size ==
+             getImageLevelSize(static_cast<VkFormat>(header.format), level.width, level.height) &&
+         level.offset + level.size <= header.dataSize;
+}
+
+}  // namespace
+
+std::string textureCachePath(const std::string &sourcePath) {
+  // appended rather than replaced, foo.png and foo.jpg must not share a cache
+  return sourcePath + kCacheExtension;
+}
+
+bool loadTextureCache(
+    const std::string &sourcePath, Texture::ImageData &imageData, bool allowBlockCompression) {
+  const bool directLoad = isCacheFile(sourcePath);
+  const std::string cachePath = directLoad ? sourcePath : textureCachePath(sourcePath);
+
+  std::error_code ec;
+  if (!fs::exists(cachePath, ec)) {
+    if (directLoad) {
+      throw std::runtime_error("failed to open texture cache: " + cachePath);
+    }
+    return false;
+  }
+
+  auto file = std::make_shared<LveMappedFile>(cachePath);
+  LveTextureFileHeader header{};
+  if (file->size() >= sizeof(header)) {
+    std::memcpy(&header, file->data(), sizeof(header));
+  }
+  bool valid = isHeaderValid(header, file->size());
+  std::vector<Texture::MipLevel> levels;
+  for (uint32_t i = 0; valid && i < header.mipLevels; i++) {
+    LveTextureFileLevel level;
+    std::memcpy(
+        &level,
+        file->data() + sizeof(LveTextureFileHeader) + i * sizeof(LveTextureFileLevel),
+        sizeof(level));
+    valid = isLevelValid(header, level, i);
+    levels.push_back(
+        {level.width,
+         level.height,
+         static_cast<size_t>(level.offset),
+         static_cast<size_t>(level.size)});
+  }
+  if (!valid) {
+    if (directLoad) {
+      throw std::runtime_error("invalid or outdated texture cache: " + cachePath);
+    }
+    return false;
+  }
+  if (!directLoad &&
+      !isSourceUnchanged(
+          sourcePath, {header.sourceSize, header.sourceModifiedTime, header.sourceHash})) {
+    return false;
+  }
+  const bool blockCompressed = isBlockCompressed(static_cast<VkFormat>(header.format));
+  if (blockCompressed && !allowBlockCompression) {
+    if (directLoad) {
+      throw std::runtime_error("device cannot sample block compressed texture: " + cachePath);
+    }
+    return false;
+  }
+  // cooked before compression was available (or turned off), cook again
+  if (!directLoad && blockCompressed != allowBlockCompression) {
+    return false;
+  }
+
+  imageData.width = static_cast<int>(header.width);
+  imageData.height = static_cast<int>(header.height);
+  imageData.format = static_cast<VkFormat>(header.format);
+  imageData.levels = std::move(levels);
+  // the pixels keep the whole mapping alive
+  const uint8_t *pixels = file->data() + header.dataOffset;
+  imageData.pixels = std::shared_ptr<const uint8_t>(std::move(file), pixels);
+  return true;
+}
+
+void writeTextureCache(const std::string &sourcePath, const Texture::ImageData &imageData) {
+  if (imageData.levels.empty()) {
+    return;
+  }
+
+  LveTextureFileHeader header{};
+  header.magic = LveTextureFileHeader::kMagic;
+  header.version = LveTextureFileHeader::kVersion;
+  header.format = static_cast<uint32_t>(imageData.format);
+  header.width = static_cast<uint32_t>(imageData.width);
+  header.height = static_cast<uint32_t>(imageData.height);
+  header.mipLevels = static_cast<uint32_t>(imageData.levels.size());
+
+  LveSourceStamp stamp;
+  if (!stampSource(sourcePath, stamp)) {
+    return;
+  }
+  header.sourceSize = stamp.size;
+  header.sourceModifiedTime = stamp.modifiedTime;
+  header.sourceHash = stamp.hash;
+
+  // levels are repacked at aligned offsets, the in-memory chain may be tightly packed
+  std::vector<LveTextureFileLevel> levels;
+  uint64_t dataSize = 0;
+  for (const auto &level : imageData.levels) {
+    dataSize = alignOffset(dataSize);
+    levels.push_back({level.width, level.height, dataSize, level.size});
+    dataSize += level.size;
+  }
+  header.dataOffset = alignOffset(
+      sizeof(LveTextureFileHeader) + levels.size() * sizeof(LveTextureFileLevel));
+  header.dataSize = dataSize;
+
+  // write to a temporary and rename so a crash or a concurrent reader never sees half a file
+  const std::string cachePath = textureCachePath(sourcePath);
+  const std::string tempPath = cachePath + ".tmp";
+  {
+    std::ofstream out{tempPath, std::ios::binary | std::ios::trunc};
+    if (!out) {
+      std::cerr << "failed to write texture cache: " << cachePath << std::endl;
+      return;
+    }
+    const char padding[LveTextureFileHeader::kSectionAlignment]{};
+    auto pad = [&](uint64_t target) {
+      out.write(padding, static_cast<std::streamsize>(target - static_cast<uint64_t>(out.tellp())));
+    };
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(
+        reinterpret_cast<const char *>(levels.data()),
+        static_cast<std::streamsize>(levels.size() * sizeof(LveTextureFileLevel)));
+    for (size_t i = 0; i < levels.size(); i++) {
+      pad(header.dataOffset + levels[i].offset);
+      out.write(
+          reinterpret_cast<const char *>(imageData.pixels.get() + imageData.levels[i].offset),
+          static_cast<std::streamsize>(levels[i].size));
+    }
+    if (!out) {
+      std::cerr << "failed to write texture cache: " << cachePath << std::endl;
+      out.close();
+      std::error_code ec;
+      fs::remove(tempPath, ec);
+      return;
+    }
+  }
+
+  std::error_code ec;
+  fs::rename(tempPath, cachePath, ec);
+  if (ec) {
+    std::cerr << "failed to write texture cache: " << cachePath << " (" << ec.message() << ")"
+              << std::endl;
+    fs::remove(tempPath, ec);
+  }
+}
+
+}  // namespace lve
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "lve_texture.hpp"
+
+// std
+#include <cstdint>
+#include <string>
+
+namespace lve {
+
+/**
+ * On-disk layout of a cooked .lvetex file. The header is followed by mipLevels
+ * LveTextureFileLevel entries and then the pixel data of every level, largest first, each
+ * starting at a kSectionAlignment aligned offset so it can be copied straight out of a mapping.
+ */
+struct LveTextureFileHeader {
+  static constexpr uint32_t kMagic = 0x5445564c;  // "LVET"
+  static constexpr uint32_t kVersion = 1;
+  static constexpr uint64_t kSectionAlignment = 16;
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t format;  // VkFormat
+  uint32_t width;
+  uint32_t height;
+  uint32_t mipLevels;
+
+  // used to detect a stale cache, the hash is only checked when size or mtime changed
+  uint64_t sourceSize;
+  int64_t sourceModifiedTime;
+  uint64_t sourceHash;
+
+  uint64_t dataOffset;
+  uint64_t dataSize;
+};
+
+struct LveTextureFileLevel {
+  uint32_t width;
+  uint32_t height;
+  uint64_t offset;  // relative to dataOffset
+  uint64_t size;
+};
+
+// textures/foo.png -> textures/foo.png.lvetex
+std::string textureCachePath(const std::string &sourcePath);
+
+/**
+ * Maps the .lvetex that belongs to sourcePath (or sourcePath itself if it is a .lvetex) into
+ * imageData. Returns false if there is no cache, it is out of date with its source or it is not
+ * block compressed exactly when allowBlockCompression says so (a direct load only has to be
+ * sampleable).
+ */
+bool loadTextureCache(
+    const std::string &sourcePath, Texture::ImageData &imageData, bool allowBlockCompression);
+
+/**
+ * Writes imageData and all of its levels next to sourcePath. Failures are reported but not fatal,
+ * the image simply gets decoded again on the next launch.
+ */
+void writeTextureCache(const std::string &sourcePath, const Texture::ImageData &imageData);
+
+}  // namespace lve
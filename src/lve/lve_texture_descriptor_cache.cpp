@@ -0,0 +1,96 @@
+#include "lve_texture_descriptor_cache.hpp"
+
+#include "lve_texture.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+
+LveTextureDescriptorCache::LveTextureDescriptorCache(
+    LveDevice &device, LveDescriptorSetLayout &setLayout, uint32_t setsPerPool)
+    : lveDevice{device}, setLayout{setLayout}, setsPerPool{setsPerPool} {}
+
+LveTextureDescriptorCache::~LveTextureDescriptorCache() {
+  // the pools take the sets with them, the textures only have to forget the cache
+  for (auto &kv : entries) {
+    const_cast<Texture *>(kv.first)->descriptorCache = nullptr;
+  }
+}
+
+void LveTextureDescriptorCache::beginFrame(int frameIndex) {
+  currentFrame = frameIndex;
+  auto done = std::partition(retired.begin(), retired.end(), [frameIndex](const Retired &set) {
+    return set.frameIndex != frameIndex;
+  });
+  for (auto it = done; it != retired.end(); ++it) {
+    std::vector<VkDescriptorSet> sets{it->set};
+    pools[it->pool]->freeDescriptors(sets);
+  }
+  retired.erase(done, retired.end());
+}
+
+VkDescriptorSet LveTextureDescriptorCache::getDescriptorSet(Texture &texture) {
+  auto it = entries.find(&texture);
+  if (it != entries.end()) {
+    if (it->second.imageView == texture.getImageView() &&
+        it->second.sampler == texture.getSampler()) {
+      return it->second.set;
+    }
+    // relocated, earlier frames may still read the old set
+    retire(it->second);
+    it->second = allocate(texture);
+    return it->second.set;
+  }
+
+  assert(
+      texture.descriptorCache == nullptr && "Texture already belongs to another descriptor cache");
+  texture.descriptorCache = this;
+  return entries.emplace(&texture, allocate(texture)).first->second.set;
+}
+
+void LveTextureDescriptorCache::invalidate(const Texture *texture) {
+  auto it = entries.find(texture);
+  if (it == entries.end()) return;
+  retire(it->second);
+  entries.erase(it);
+}
+
+LveTextureDescriptorCache::Entry LveTextureDescriptorCache::allocate(Texture &texture) {
+  LveDescriptorInfo info{};
+  info.image.sampler = texture.getSampler();
+  info.image.imageView = texture.getImageView();
+  info.image.imageLayout = texture.getImageLayout();
+
+  Entry entry{VK_NULL_HANDLE, kNoPool, info.image.imageView, info.image.sampler};
+  // freed sets leave holes in the older pools, so they are tried first
+  for (uint32_t i = 0; i < pools.size(); i++) {
+    if (pools[i]->allocateDescriptor(setLayout.getDescriptorSetLayout(), entry.set)) {
+      entry.pool = i;
+      break;
+    }
+  }
+  if (entry.pool == kNoPool) {
+    pools.push_back(LveDescriptorPool::Builder(lveDevice)
+                        .setMaxSets(setsPerPool)
+                        .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, setsPerPool)
+                        .setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT)
+                        .build());
+    entry.pool = static_cast<uint32_t>(pools.size() - 1);
+    if (!pools.back()->allocateDescriptor(setLayout.getDescriptorSetLayout(), entry.set)) {
+      throw std::runtime_error("failed to allocate texture descriptor set!");
+    }
+  }
+
+  // through the layout's update template, no write structs to fill in
+  setLayout.update(entry.set, &info);
+  return entry;
+}
+
+void LveTextureDescriptorCache::retire(const Entry &entry) {
+  retired.push_back({entry.set, entry.pool, currentFrame});
+}
+
+}  // namespace lve
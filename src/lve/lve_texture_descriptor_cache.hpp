@@ -0,0 +1,73 @@
+#pragma once
+
+#include "lve_descriptors.hpp"
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+
+class Texture;
+
+/**
+ * One descriptor set per texture, written the first time the texture is drawn and bound as is
+ * from then on. A texture drops its set when it is destroyed, and a set whose image view or
+ * sampler no longer matches (the texture was relocated) is written anew. Sets that go away are
+ * only freed once the frame slot they were retired in comes around again, so frames in flight
+ * can still read them. Either side may go first, a cache that is destroyed detaches itself from
+ * the textures it still holds sets for.
+ */
+class LveTextureDescriptorCache {
+ public:
+  // setLayout holds a single combined image sampler at binding 0 and has to outlive the cache
+  LveTextureDescriptorCache(
+      LveDevice &device, LveDescriptorSetLayout &setLayout, uint32_t setsPerPool = 256);
+  ~LveTextureDescriptorCache();
+
+  LveTextureDescriptorCache(const LveTextureDescriptorCache &) = delete;
+  LveTextureDescriptorCache &operator=(const LveTextureDescriptorCache &) = delete;
+
+  /**
+   * Frees the sets retired the last time frameIndex was recorded, call it once per frame before
+   * any getDescriptorSet(). The frame's fence has been waited for by then.
+   */
+  void beginFrame(int frameIndex);
+  VkDescriptorSet getDescriptorSet(Texture &texture);
+  // called by the texture's destructor
+  void invalidate(const Texture *texture);
+
+  size_t getSetCount() const { return entries.size(); }
+
+ private:
+  static constexpr uint32_t kNoPool = ~0u;
+
+  struct Entry {
+    VkDescriptorSet set;
+    uint32_t pool;
+    VkImageView imageView;
+    VkSampler sampler;
+  };
+  struct Retired {
+    VkDescriptorSet set;
+    uint32_t pool;
+    int frameIndex;
+  };
+
+  Entry allocate(Texture &texture);
+  void retire(const Entry &entry);
+
+  LveDevice &lveDevice;
+  LveDescriptorSetLayout &setLayout;
+  uint32_t setsPerPool;
+  // a new pool is added whenever the others are full, none is ever reset
+  std::vector<std::unique_ptr<LveDescriptorPool>> pools;
+  std::unordered_map<const Texture *, Entry> entries;
+  std::vector<Retired> retired;
+  int currentFrame = 0;
+};
+
+}  // namespace lve
@@ -0,0 +1,58 @@
+#include "lve_thread_pool.hpp"
+
+// std
+#include <algorithm>
+
+namespace lve {
+
+LveThreadPool::LveThreadPool(uint32_t threadCount) {
+  if (threadCount == 0) {
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+  workers.reserve(threadCount);
+  for (uint32_t i = 0; i < threadCount; i++) {
+    workers.emplace_back([this]() { workerLoop(); });
+  }
+}
+
+LveThreadPool::~LveThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock{queueMutex};
+    stopping = true;
+  }
+  queueCondition.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+LveThreadPool &LveThreadPool::shared() {
+  static LveThreadPool pool{};
+  return pool;
+}
+
+void LveThreadPool::enqueue(std::function<void()> job) {
+  {
+    std::lock_guard<std::mutex> lock{queueMutex};
+    jobs.push(std::move(job));
+  }
+  queueCondition.notify_one();
+}
+
+void LveThreadPool::workerLoop() {
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock{queueMutex};
+      queueCondition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+      if (stopping && jobs.empty()) {
+        return;
+      }
+      job = std::move(jobs.front());
+      jobs.pop();
+    }
+    job();
+  }
+}
+
+}  // namespace lve
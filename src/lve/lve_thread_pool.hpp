@@ -0,0 +1,108 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace lve {
+
+/**
+ * Fixed set of worker threads pulling jobs from a shared queue. Used for CPU side asset work
+ * (parsing, cooking, decoding) that would otherwise run on a single core.
+ */
+class LveThreadPool {
+ public:
+  // threadCount == 0 picks one worker per hardware thread
+  explicit LveThreadPool(uint32_t threadCount = 0);
+  ~LveThreadPool();
+
+  LveThreadPool(const LveThreadPool &) = delete;
+  LveThreadPool &operator=(const LveThreadPool &) = delete;
+
+  // process wide pool, created on first use
+  static LveThreadPool &shared();
+
+  uint32_t getThreadCount() const { return static_cast<uint32_t>(workers.size()); }
+
+  template <typename F>
+  std::future<std::invoke_result_t<F>> submit(F &&job) {
+    using Result = std::invoke_result_t<F>;
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+    std::future<Result> result = task->get_future();
+    enqueue([task]() { (*task)(); });
+    return result;
+  }
+
+  /**
+   * Runs fn(i) for every i in [0, count) and returns once all of them finished. The calling thread
+   * works through the range as well, so this is safe to call from inside a pool job.
+   */
+  template <typename F>
+  void parallelFor(size_t count, F &&fn) {
+    if (count == 0) return;
+    if (count == 1 || workers.empty()) {
+      for (size_t i = 0; i < count; i++) fn(i);
+      return;
+    }
+
+    struct Batch {
+      std::atomic<size_t> next{0};
+      std::atomic<size_t> done{0};
+      std::mutex mutex;
+      std::condition_variable finished;
+      std::exception_ptr error;
+    };
+    auto batch = std::make_shared<Batch>();
+    // helpers that start after the caller drained the range find nothing left and return, so
+    // capturing fn by reference is fine: every fn(i) completes before this function returns
+    auto work = [batch, count, &fn]() {
+      size_t i;
+      while ((i = batch->next.fetch_add(1)) < count) {
+        try {
+          fn(i);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock{batch->mutex};
+          if (!batch->error) batch->error = std::current_exception();
+        }
+        if (batch->done.fetch_add(1) + 1 == count) {
+          std::lock_guard<std::mutex> lock{batch->mutex};
+          batch->finished.notify_all();
+        }
+      }
+    };
+
+    size_t helpers = std::min(count - 1, workers.size());
+    for (size_t i = 0; i < helpers; i++) {
+      enqueue(work);
+    }
+    work();
+
+    std::unique_lock<std::mutex> lock{batch->mutex};
+    batch->finished.wait(lock, [&]() { return batch->done.load() == count; });
+    if (batch->error) std::rethrow_exception(batch->error);
+  }
+
+ private:
+  void enqueue(std::function<void()> job);
+  void workerLoop();
+
+  std::vector<std::thread> workers;
+  std::queue<std::function<void()>> jobs;
+  std::mutex queueMutex;
+  std::condition_variable queueCondition;
+  bool stopping = false;
+};
+
+}  // namespace lve
@@ -0,0 +1,431 @@
+#include "lve_upload_context.hpp"
+
+// std
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace lve {
+
+namespace {
+
+// covers the texel block size of every format and the 4 byte granularity of buffer copies
+constexpr VkDeviceSize kStagingAlignment = 16;
+
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool commandPool) {
+  VkCommandBufferAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandPool = commandPool;
+  allocInfo.commandBufferCount = 1;
+  VkCommandBuffer commandBuffer;
+  if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+    throw std::runtime_error("failed to allocate upload command buffer!");
+  }
+  return commandBuffer;
+}
+
+void beginCommandBuffer(VkCommandBuffer commandBuffer) {
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(commandBuffer, &beginInfo);
+}
+
+}  // namespace
+
+LveUploadContext::LveUploadContext(LveDevice &device, VkDeviceSize stagingSize)
+    : lveDevice{device}, stagingRanges{stagingSize} {
+  if (lveDevice.supportsTimelineSemaphores()) {
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+    if (vkCreateSemaphore(lveDevice.device(), &semaphoreInfo, nullptr, &timeline) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create upload timeline semaphore!");
+    }
+    // the acquire side needs the timeline to wait for the transfer queue
+    transferQueue = lveDevice.hasDedicatedTransferQueue();
+  }
+
+  if (stagingSize > 0) {
+    stagingBuffer = std::make_unique<LveBuffer>(
+        lveDevice,
+        stagingSize,
+        1,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    stagingBuffer->map();
+  }
+}
+
+LveUploadContext::~LveUploadContext() {
+  // submits a batch still being recorded, so every batch ends up in spare
+  waitIdle();
+  for (auto &batch : spare) {
+    vkFreeCommandBuffers(lveDevice.device(), getBatchCommandPool(), 1, &batch.commandBuffer);
+    if (batch.acquireCommandBuffer != VK_NULL_HANDLE) {
+      vkFreeCommandBuffers(
+          lveDevice.device(), lveDevice.getCommandPool(), 1, &batch.acquireCommandBuffer);
+    }
+    if (batch.fence != VK_NULL_HANDLE) {
+      vkDestroyFence(lveDevice.device(), batch.fence, nullptr);
+    }
+  }
+  if (timeline != VK_NULL_HANDLE) {
+    vkDestroySemaphore(lveDevice.device(), timeline, nullptr);
+  }
+}
+
+LveUploadContext::Batch &LveUploadContext::openBatch() {
+  if (recording) {
+    return current;
+  }
+
+  if (!spare.empty()) {
+    current = std::move(spare.back());
+    spare.pop_back();
+    vkResetCommandBuffer(current.commandBuffer, 0);
+    if (current.acquireCommandBuffer != VK_NULL_HANDLE) {
+      vkResetCommandBuffer(current.acquireCommandBuffer, 0);
+    }
+    if (current.fence != VK_NULL_HANDLE) {
+      vkResetFences(lveDevice.device(), 1, &current.fence);
+    }
+  } else {
+    current = Batch{};
+    current.commandBuffer = allocateCommandBuffer(lveDevice.device(), getBatchCommandPool());
+    if (transferQueue) {
+      current.acquireCommandBuffer =
+          allocateCommandBuffer(lveDevice.device(), lveDevice.getCommandPool());
+    }
+    if (timeline == VK_NULL_HANDLE) {
+      VkFenceCreateInfo fenceInfo{};
+      fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+      if (vkCreateFence(lveDevice.device(), &fenceInfo, nullptr, &current.fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upload fence!");
+      }
+    }
+  }
+
+  current.serial = ++batchSerial;
+  beginCommandBuffer(current.commandBuffer);
+  if (current.acquireCommandBuffer != VK_NULL_HANDLE) {
+    beginCommandBuffer(current.acquireCommandBuffer);
+  }
+  recording = true;
+  return current;
+}
+
+VkCommandBuffer LveUploadContext::getCommandBuffer() { return openBatch().commandBuffer; }
+
+LveUploadContext::StagingRegion LveUploadContext::allocateStaging(VkDeviceSize size) {
+  if (stagingBuffer != nullptr && size <= stagingRanges.getCapacity()) {
+    while (true) {
+      uint64_t offset = stagingRanges.allocate(size, kStagingAlignment);
+      if (offset != LveRangeAllocator::kInvalidOffset) {
+        openBatch().stagingRanges.emplace_back(offset, size);
+        return {
+            stagingBuffer->getBuffer(),
+            offset,
+            static_cast<uint8_t *>(stagingBuffer->getMappedMemory()) + offset};
+      }
+      // full, the open batch can only give its ranges back once it ran
+      if (inFlight.empty()) submit();
+      if (inFlight.empty()) break;
+      waitOldest();
+    }
+  }
+
+  // does not fit, a buffer of its own that lives as long as the batch
+  auto buffer = std::make_shared<LveBuffer>(
+      lveDevice,
+      size,
+      1,
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  buffer->map();
+  StagingRegion region{buffer->getBuffer(), 0, static_cast<uint8_t *>(buffer->getMappedMemory())};
+  keepAlive(std::move(buffer));
+  return region;
+}
+
+void LveUploadContext::uploadBuffer(
+    const void *data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset) {
+  StagingRegion staging = allocateStaging(size);
+  std::memcpy(staging.mapped, data, static_cast<size_t>(size));
+
+  VkBufferCopy copyRegion{};
+  copyRegion.srcOffset = staging.offset;
+  copyRegion.dstOffset = dstOffset;
+  copyRegion.size = size;
+  vkCmdCopyBuffer(getCommandBuffer(), staging.buffer, dstBuffer, 1, &copyRegion);
+  finishBufferUpload(dstBuffer, dstOffset, size);
+}
+
+void LveUploadContext::keepAlive(std::shared_ptr<const void> resource) {
+  openBatch().keepAlive.push_back(std::move(resource));
+}
+
+void LveUploadContext::finishBufferUpload(
+    VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size) {
+  if (!transferQueue) {
+    // covered by the barrier at the end of the batch
+    return;
+  }
+  Batch &batch = openBatch();
+
+  VkBufferMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier.srcQueueFamilyIndex = lveDevice.getTransferQueueFamily();
+  barrier.dstQueueFamilyIndex = lveDevice.getGraphicsQueueFamily();
+  barrier.buffer = buffer;
+  barrier.offset = offset;
+  barrier.size = size;
+
+  // release, the destination half of the barrier is ignored on this queue
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = 0;
+  vkCmdPipelineBarrier(
+      batch.commandBuffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+      0,
+      0,
+      nullptr,
+      1,
+      &barrier,
+      0,
+      nullptr);
+
+  // acquire, the semaphore wait already orders it after the release
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                          VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+  vkCmdPipelineBarrier(
+      batch.acquireCommandBuffer,
+      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+      VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+      0,
+      0,
+      nullptr,
+      1,
+      &barrier,
+      0,
+      nullptr);
+}
+
+void LveUploadContext::finishImageUpload(VkImage image, uint32_t mipLevels) {
+  Batch &batch = openBatch();
+
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.baseMipLevel = 0;
+  barrier.subresourceRange.levelCount = mipLevels;
+  barrier.subresourceRange.baseArrayLayer = 0;
+  barrier.subresourceRange.layerCount = 1;
+
+  if (!transferQueue) {
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(
+        batch.commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        1,
+        &barrier);
+    return;
+  }
+
+  // the layout transition is part of the ownership transfer, both halves have to describe it
+  barrier.srcQueueFamilyIndex = lveDevice.getTransferQueueFamily();
+  barrier.dstQueueFamilyIndex = lveDevice.getGraphicsQueueFamily();
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = 0;
+  vkCmdPipelineBarrier(
+      batch.commandBuffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+      0,
+      0,
+      nullptr,
+      0,
+      nullptr,
+      1,
+      &barrier);
+
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  vkCmdPipelineBarrier(
+      batch.acquireCommandBuffer,
+      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+      0,
+      0,
+      nullptr,
+      0,
+      nullptr,
+      1,
+      &barrier);
+}
+
+VkCommandPool LveUploadContext::getBatchCommandPool() {
+  // without the timeline the batch goes to the graphics queue even if the device has a transfer
+  // family, so its command buffer has to come from the graphics family as well
+  return transferQueue ? lveDevice.getTransferCommandPool() : lveDevice.getCommandPool();
+}
+
+void LveUploadContext::submit() {
+  if (!recording) return;
+
+  if (!transferQueue) {
+    // every buffer copied into this batch may be read by anything submitted after it
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+    vkCmdPipelineBarrier(
+        current.commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0,
+        1,
+        &barrier,
+        0,
+        nullptr,
+        0,
+        nullptr);
+  }
+  vkEndCommandBuffer(current.commandBuffer);
+
+  if (transferQueue) {
+    vkEndCommandBuffer(current.acquireCommandBuffer);
+    uint64_t copiedValue = ++timelineValue;
+    submitCommands(lveDevice.transferQueue(), current.commandBuffer, 0, copiedValue, VK_NULL_HANDLE);
+    current.completeValue = ++timelineValue;
+    submitCommands(
+        lveDevice.graphicsQueue(),
+        current.acquireCommandBuffer,
+        copiedValue,
+        current.completeValue,
+        VK_NULL_HANDLE);
+  } else if (timeline != VK_NULL_HANDLE) {
+    current.completeValue = ++timelineValue;
+    submitCommands(
+        lveDevice.graphicsQueue(), current.commandBuffer, 0, current.completeValue, VK_NULL_HANDLE);
+  } else {
+    submitCommands(lveDevice.graphicsQueue(), current.commandBuffer, 0, 0, current.fence);
+  }
+
+  inFlight.push_back(std::move(current));
+  current = Batch{};
+  recording = false;
+}
+
+void LveUploadContext::submitCommands(
+    VkQueue queue,
+    VkCommandBuffer commandBuffer,
+    uint64_t waitValue,
+    uint64_t signalValue,
+    VkFence fence) {
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &commandBuffer;
+
+  // value 0 means no wait or no signal, the timeline starts there and never goes back to it
+  VkTimelineSemaphoreSubmitInfo timelineInfo{};
+  VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  if (timeline != VK_NULL_HANDLE) {
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    if (waitValue > 0) {
+      timelineInfo.waitSemaphoreValueCount = 1;
+      timelineInfo.pWaitSemaphoreValues = &waitValue;
+      submitInfo.waitSemaphoreCount = 1;
+      submitInfo.pWaitSemaphores = &timeline;
+      submitInfo.pWaitDstStageMask = &waitStage;
+    }
+    if (signalValue > 0) {
+      timelineInfo.signalSemaphoreValueCount = 1;
+      timelineInfo.pSignalSemaphoreValues = &signalValue;
+      submitInfo.signalSemaphoreCount = 1;
+      submitInfo.pSignalSemaphores = &timeline;
+    }
+    submitInfo.pNext = &timelineInfo;
+  }
+
+  if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS) {
+    throw std::runtime_error("failed to submit upload batch!");
+  }
+}
+
+bool LveUploadContext::isComplete(const Batch &batch) {
+  if (timeline != VK_NULL_HANDLE) {
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(lveDevice.device(), timeline, &value);
+    return value >= batch.completeValue;
+  }
+  return vkGetFenceStatus(lveDevice.device(), batch.fence) == VK_SUCCESS;
+}
+
+void LveUploadContext::collect() {
+  // batches complete in submission order, the first unfinished one ends the scan
+  while (!inFlight.empty() && isComplete(inFlight.front())) {
+    release(inFlight.front());
+    spare.push_back(std::move(inFlight.front()));
+    inFlight.pop_front();
+  }
+}
+
+void LveUploadContext::waitIdle() {
+  submit();
+  while (!inFlight.empty()) {
+    waitOldest();
+  }
+}
+
+void LveUploadContext::waitOldest() {
+  Batch &oldest = inFlight.front();
+  if (timeline != VK_NULL_HANDLE) {
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timeline;
+    waitInfo.pValues = &oldest.completeValue;
+    vkWaitSemaphores(lveDevice.device(), &waitInfo, std::numeric_limits<uint64_t>::max());
+  } else {
+    vkWaitForFences(
+        lveDevice.device(), 1, &oldest.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+  }
+  release(oldest);
+  spare.push_back(std::move(oldest));
+  inFlight.pop_front();
+}
+
+void LveUploadContext::release(Batch &batch) {
+  for (const auto &range : batch.stagingRanges) {
+    stagingRanges.free(range.first, range.second);
+  }
+  batch.stagingRanges.clear();
+  batch.keepAlive.clear();
+  completedSerial = batch.serial;
+}
+
+}  // namespace lve
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "lve_buffer.hpp"
+#include "lve_device.hpp"
+#include "lve_range_allocator.hpp"
+
+// std
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace lve {
+
+/**
+ * Records buffer and image uploads into one command buffer and submits them together, instead of
+ * a one-shot command buffer and a vkQueueWaitIdle per copy. Staging memory comes from a buffer
+ * that is reused across batches: a batch's ranges (and anything it was asked to keep alive) are
+ * released once the GPU is done with it.
+ *
+ * With a dedicated transfer queue and timeline semaphores the copies run there, beside rendering.
+ * Every finished resource is released to the graphics family at the end of the transfer batch and
+ * acquired by a small graphics submission that waits for it on the timeline, so whatever is
+ * submitted to the graphics queue afterwards sees the data without the CPU waiting at all.
+ * Otherwise the batch runs on the graphics queue and ends with one barrier for all of it.
+ * Main thread only, like the command pools it records from.
+ */
+class LveUploadContext {
+ public:
+  struct StagingRegion {
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    uint8_t *mapped;
+  };
+
+  // stagingSize == 0 gives every upload a staging buffer of its own
+  explicit LveUploadContext(LveDevice &device, VkDeviceSize stagingSize = 32 * 1024 * 1024);
+  // submits what is still recorded and waits for every batch
+  ~LveUploadContext();
+
+  LveUploadContext(const LveUploadContext &) = delete;
+  LveUploadContext &operator=(const LveUploadContext &) = delete;
+
+  // command buffer of the open batch, begun on first use
+  VkCommandBuffer getCommandBuffer();
+
+  /**
+   * size bytes of mapped staging memory, valid until the open batch completes. Waits for older
+   * batches when the staging buffer is full, anything larger than it gets a buffer of its own.
+   * Get the region before the command buffer, a full staging buffer may submit the open batch.
+   */
+  StagingRegion allocateStaging(VkDeviceSize size);
+  // stages data and records a copy of it to dstBuffer
+  void uploadBuffer(
+      const void *data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset = 0);
+  // resource is released once the open batch completed, e.g. memory another staging buffer owns
+  void keepAlive(std::shared_ptr<const void> resource);
+
+  // hands a buffer range the open batch wrote over to the graphics queue
+  void finishBufferUpload(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size);
+  // the same for all levels of an image in TRANSFER_DST_OPTIMAL, it ends up SHADER_READ_ONLY_OPTIMAL
+  void finishImageUpload(VkImage image, uint32_t mipLevels);
+
+  // submits the open batch if anything was recorded, does not wait
+  void submit();
+  // releases the staging memory of completed batches, never blocks
+  void collect();
+  // submits and blocks until every batch completed
+  void waitIdle();
+
+  uint32_t getPendingBatchCount() const { return static_cast<uint32_t>(inFlight.size()); }
+  // nothing recorded and nothing in flight, as of the last collect() or wait
+  bool isIdle() const { return !recording && inFlight.empty(); }
+  // batches are numbered from 1, this is the open one or the last submitted when none is open
+  uint64_t getBatchSerial() const { return batchSerial; }
+  // batches complete in order, as of the last collect() or wait
+  bool isBatchComplete(uint64_t serial) const { return serial <= completedSerial; }
+  bool usesTransferQueue() const { return transferQueue; }
+
+ private:
+  struct Batch {
+    // transfer queue, or the graphics queue when there is no dedicated one or no timeline
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    // graphics queue acquire barriers, only used with a dedicated transfer queue
+    VkCommandBuffer acquireCommandBuffer = VK_NULL_HANDLE;
+    // completion: a timeline value, or a fence on devices without timeline semaphores
+    uint64_t completeValue = 0;
+    uint64_t serial = 0;
+    VkFence fence = VK_NULL_HANDLE;
+    std::vector<std::pair<VkDeviceSize, VkDeviceSize>> stagingRanges;
+    std::vector<std::shared_ptr<const void>> keepAlive;
+  };
+
+  Batch &openBatch();
+  // of the family the batches are submitted to
+  VkCommandPool getBatchCommandPool();
+  void submitCommands(
+      VkQueue queue,
+      VkCommandBuffer commandBuffer,
+      uint64_t waitValue,
+      uint64_t signalValue,
+      VkFence fence);
+  bool isComplete(const Batch &batch);
+  void release(Batch &batch);
+  void waitOldest();
+
+  LveDevice &lveDevice;
+  bool transferQueue = false;
+  VkSemaphore timeline = VK_NULL_HANDLE;
+  uint64_t timelineValue = 0;
+  std::unique_ptr<LveBuffer> stagingBuffer;
+  LveRangeAllocator stagingRanges;
+
+  bool recording = false;
+  uint64_t batchSerial = 0;
+  uint64_t completedSerial = 0;
+  Batch current;
+  std::deque<Batch> inFlight;
+  // completed batches, their command buffers and fences are reused
+  std::vector<Batch> spare;
+};
+
+}  // namespace lve
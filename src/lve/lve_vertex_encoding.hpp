@@ -0,0 +1,64 @@
+#pragma once
+
+// libs
+#include <glm/glm.hpp>
+
+// std
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace lve {
+
+// round to nearest even fp32 -> fp16, overflow saturates to infinity
+inline uint16_t floatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  uint32_t sign = (bits >> 16) & 0x8000u;
+  uint32_t magnitude = bits & 0x7fffffffu;
+
+  if (magnitude >= 0x7f800000u) {  // inf / nan
+    return static_cast<uint16_t>(sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x200u : 0u));
+  }
+  if (magnitude >= 0x477ff000u) {  // rounds above the largest half
+    return static_cast<uint16_t>(sign | 0x7c00u);
+  }
+  if (magnitude < 0x38800000u) {  // half denormal or zero
+    float absolute;
+    std::memcpy(&absolute, &magnitude, sizeof(absolute));
+    return static_cast<uint16_t>(sign | static_cast<uint32_t>(std::nearbyint(absolute * 16777216.f)));
+  }
+  uint32_t rounded = magnitude + 0xfffu + ((magnitude >> 13) & 1u) - (112u << 23);
+  return static_cast<uint16_t>(sign | (rounded >> 13));
+}
+
+inline uint16_t floatToUnorm16(float value) {
+  return static_cast<uint16_t>(std::lround(glm::clamp(value, 0.f, 1.f) * 65535.f));
+}
+
+inline int16_t floatToSnorm16(float value) {
+  return static_cast<int16_t>(std::lround(glm::clamp(value, -1.f, 1.f) * 32767.f));
+}
+
+/**
+ * Octahedral normal encoding packed as two snorm16 (x in the low half). Decoded in the shader by
+ * octDecode(), zero vectors come back as +z.
+ */
+inline uint32_t octEncodeNormal(glm::vec3 normal) {
+  float lengthL1 = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+  glm::vec2 encoded{0.f};
+  if (lengthL1 > 0.f) {
+    normal /= lengthL1;
+    encoded = {normal.x, normal.y};
+    if (normal.z < 0.f) {
+      encoded = {
+          (1.f - std::fabs(normal.y)) * (normal.x >= 0.f ? 1.f : -1.f),
+          (1.f - std::fabs(normal.x)) * (normal.y >= 0.f ? 1.f : -1.f)};
+    }
+  }
+  uint16_t x = static_cast<uint16_t>(floatToSnorm16(encoded.x));
+  uint16_t y = static_cast<uint16_t>(floatToSnorm16(encoded.y));
+  return static_cast<uint32_t>(x) | (static_cast<uint32_t>(y) << 16);
+}
+
+}  // namespace lve
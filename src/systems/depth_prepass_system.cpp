@@ -0,0 +1,129 @@
+#include "depth_prepass_system.hpp"
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+
+struct DepthPrepassPushConstantData {
+  glm::mat4 modelMatrix{1.f};
+};
+
+DepthPrepassSystem::DepthPrepassSystem(
+    LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout)
+    : lveDevice{device} {
+  createPipelineLayout(globalSetLayout);
+  createPipeline(renderPass);
+}
+
+DepthPrepassSystem::~DepthPrepassSystem() {
+  vkDestroyPipelineLayout(lveDevice.device(), pipelineLayout, nullptr);
+}
+
+void DepthPrepassSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
+  VkPushConstantRange pushConstantRange{};
+  pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+  pushConstantRange.offset = 0;
+  pushConstantRange.size = sizeof(DepthPrepassPushConstantData);
+
+  std::vector<VkDescriptorSetLayout> descriptorSetLayouts{globalSetLayout};
+
+  VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+  pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+  pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+  pipelineLayoutInfo.pushConstantRangeCount = 1;
+  pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+  if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("failed to create pipeline layout!");
+  }
+}
+
+void DepthPrepassSystem::createPipeline(VkRenderPass renderPass) {
+  assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
+
+  for (uint32_t i = 0; i < LveModel::kVertexFormatCount; i++) {
+    auto format = static_cast<LveModel::VertexFormat>(i);
+    // rasterization state has to match SimpleRenderSystem, or EQUAL testing breaks
+    PipelineConfigInfo pipelineConfig{};
+    LvePipeline::defaultPipelineConfigInfo(pipelineConfig);
+    LvePipeline::enableBackFaceCulling(pipelineConfig);
+    LvePipeline::disableColorWrites(pipelineConfig);
+    pipelineConfig.bindingDescriptions = LveModel::getPositionBindingDescriptions(format);
+    pipelineConfig.attributeDescriptions = LveModel::getPositionAttributeDescriptions(format);
+    pipelineConfig.renderPass = renderPass;
+    pipelineConfig.pipelineLayout = pipelineLayout;
+    coneCulling = pipelineConfig.rasterizationInfo.cullMode & VK_CULL_MODE_BACK_BIT;
+    lvePipelines[i] = std::make_unique<LvePipeline>(
+        lveDevice,
+        "shaders/depth_prepass.vert.spv",
+        "",
+        pipelineConfig);
+  }
+}
+
+void DepthPrepassSystem::render(
+    FrameInfo& frameInfo, const std::vector<SimpleRenderSystem::DrawEntry>& drawEntries) {
+  // grouped by vertex format, front to back inside each group, so hidden surfaces already fail
+  // the depth test here
+  renderQueue.clear();
+  for (uint32_t i = 0; i < drawEntries.size(); i++) {
+    const LveModel& model = *drawEntries[i].object->model;
+    if (!model.hasPositionStream()) continue;
+    uint32_t format = static_cast<uint32_t>(model.getVertexFormat());
+    renderQueue.submit(LveRenderQueue::makeKey(0, format, 0, 0, drawEntries[i].distance), i);
+  }
+  renderQueue.sort();
+
+  LvePipeline* boundPipeline = lvePipelines[0].get();
+  boundPipeline->bind(frameInfo.commandBuffer);
+
+  vkCmdBindDescriptorSets(
+      frameInfo.commandBuffer,
+      VK_PIPELINE_BIND_POINT_GRAPHICS,
+      pipelineLayout,
+      0,
+      1,
+      &frameInfo.globalDescriptorSet,
+      0,
+      nullptr);
+
+  const LveModel* boundModel = nullptr;
+  for (const auto& packet : renderQueue.getPackets()) {
+    const auto& entry = drawEntries[packet.item];
+    LveModel& model = *entry.object->model;
+
+    LvePipeline* pipeline = lvePipelines[static_cast<uint32_t>(model.getVertexFormat())].get();
+    if (pipeline != boundPipeline) {
+      pipeline->bind(frameInfo.commandBuffer);
+      boundPipeline = pipeline;
+    }
+
+    // same expression as SimpleRenderSystem, the matrices have to match bit for bit
+    DepthPrepassPushConstantData push{};
+    push.modelMatrix = entry.worldMatrix * model.getDequantizationMatrix();
+    vkCmdPushConstants(
+        frameInfo.commandBuffer,
+        pipelineLayout,
+        VK_SHADER_STAGE_VERTEX_BIT,
+        0,
+        sizeof(DepthPrepassPushConstantData),
+        &push);
+    model.bind(frameInfo.commandBuffer, boundModel, LveModel::VertexStream::Positions);
+    boundModel = &model;
+    model.drawVisible(
+        frameInfo.commandBuffer,
+        LveClusterCullInfo{frameInfo.camera, entry.worldMatrix, coneCulling},
+        entry.lod,
+        LveModel::VertexStream::Positions);
+  }
+}
+
+}  // namespace lve
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "lve/lve_device.hpp"
+#include "lve/lve_frame_info.hpp"
+#include "lve/lve_model.hpp"
+#include "lve/lve_pipeline.hpp"
+#include "lve/lve_render_queue.hpp"
+#include "systems/simple_render_system.hpp"
+
+// std
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace lve {
+
+/**
+ * Lays down depth for the objects SimpleRenderSystem is about to draw, reading only their position
+ * streams. The main pass then shades each pixel once, with SimpleRenderSystem::setDepthPrepass
+ * switching it to an EQUAL depth test. Uses the same lods and culling as the main pass, so both
+ * passes rasterize exactly the same triangles.
+ */
+class DepthPrepassSystem {
+ public:
+  DepthPrepassSystem(
+      LveDevice &device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
+  ~DepthPrepassSystem();
+
+  DepthPrepassSystem(const DepthPrepassSystem &) = delete;
+  DepthPrepassSystem &operator=(const DepthPrepassSystem &) = delete;
+
+  // drawEntries from SimpleRenderSystem::getDrawEntries() after selectLods for this frame
+  void render(FrameInfo &frameInfo, const std::vector<SimpleRenderSystem::DrawEntry> &drawEntries);
+
+ private:
+  void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
+  void createPipeline(VkRenderPass renderPass);
+
+  LveDevice &lveDevice;
+
+  // one pipeline per LveModel::VertexFormat, all sharing the position only vertex shader
+  std::array<std::unique_ptr<LvePipeline>, LveModel::kVertexFormatCount> lvePipelines;
+  VkPipelineLayout pipelineLayout;
+  bool coneCulling = false;
+  LveRenderQueue renderQueue;
+};
+
+}  // namespace lve
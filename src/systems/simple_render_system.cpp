@@ -7,8 +7,11 @@
 #include <glm/gtc/constants.hpp>
 
 // std
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cmath>
+#include <numeric>
 #include <stdexcept>
 
 namespace lve {
@@ -18,13 +21,21 @@ struct SimplePushConstantData {
   glm::mat4 normalMatrix{1.f};
 };
 
+// keeps the camera from dividing by zero when it is inside an object's bounds
+constexpr float kMinLodDistance = .01f;
+
 SimpleRenderSystem::SimpleRenderSystem(
     LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout)
     : lveDevice{device} {
-  //text desc set layout
-  textureSetLayout = LveDescriptorSetLayout::Builder(lveDevice)
-                         .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-                         .build();
+  if (lveDevice.supportsBindlessTextures()) {
+    bindlessTextures = std::make_unique<LveBindlessTextures>(lveDevice);
+  } else {
+    //text desc set layout
+    textureSetLayout = LveDescriptorSetLayout::Builder(lveDevice)
+                           .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+                           .buildCached();
+    textureDescriptors = std::make_unique<LveTextureDescriptorCache>(lveDevice, *textureSetLayout);
+  }
 
   createPipelineLayout(globalSetLayout);
   createPipeline(renderPass);
@@ -46,7 +57,9 @@ void SimpleRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLay
 //                                  .build();
 
   //define pipeline layout with both sets, global data, texture
-  std::vector<VkDescriptorSetLayout> descriptorSetLayouts{globalSetLayout, textureSetLayout->getDescriptorSetLayout()};
+  LveDescriptorSetLayout& textureLayout =
+      bindlessTextures != nullptr ? bindlessTextures->getSetLayout() : *textureSetLayout;
+  std::vector<VkDescriptorSetLayout> descriptorSetLayouts{globalSetLayout, textureLayout.getDescriptorSetLayout()};
 
   VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
   pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -63,68 +76,202 @@ void SimpleRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLay
 void SimpleRenderSystem::createPipeline(VkRenderPass renderPass) {
   assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
 
-  PipelineConfigInfo pipelineConfig{};
-  LvePipeline::defaultPipelineConfigInfo(pipelineConfig);
-  pipelineConfig.renderPass = renderPass;
-  pipelineConfig.pipelineLayout = pipelineLayout;
-  lvePipeline = std::make_unique<LvePipeline>(
-      lveDevice,
-      "shaders/simple_shader.vert.spv",
-      "shaders/simple_shader.frag.spv",
-      pipelineConfig);
+  for (uint32_t i = 0; i < LveModel::kVertexFormatCount; i++) {
+    auto format = static_cast<LveModel::VertexFormat>(i);
+    PipelineConfigInfo pipelineConfig{};
+    LvePipeline::defaultPipelineConfigInfo(pipelineConfig);
+    LvePipeline::enableBackFaceCulling(pipelineConfig);
+    pipelineConfig.bindingDescriptions = LveModel::getBindingDescriptions(format);
+    pipelineConfig.attributeDescriptions = LveModel::getAttributeDescriptions(format);
+    pipelineConfig.renderPass = renderPass;
+    pipelineConfig.pipelineLayout = pipelineLayout;
+    coneCulling = pipelineConfig.rasterizationInfo.cullMode & VK_CULL_MODE_BACK_BIT;
+    const char* vertFilepath = format == LveModel::VertexFormat::Float32
+                                   ? "shaders/simple_shader.vert.spv"
+                                   : "shaders/simple_shader_compact.vert.spv";
+    const char* fragFilepath = bindlessTextures != nullptr
+                                   ? "shaders/simple_shader_bindless.frag.spv"
+                                   : "shaders/simple_shader.frag.spv";
+    lvePipelines[i] = std::make_unique<LvePipeline>(
+        lveDevice,
+        vertFilepath,
+        fragFilepath,
+        pipelineConfig);
+
+    LvePipeline::enableDepthEqualTest(pipelineConfig);
+    depthEqualPipelines[i] = std::make_unique<LvePipeline>(
+        lveDevice,
+        vertFilepath,
+        fragFilepath,
+        pipelineConfig);
+  }
+}
+
+void SimpleRenderSystem::selectLods(FrameInfo& frameInfo) {
+  drawEntries.clear();
+  const glm::vec3 cameraPosition = frameInfo.camera.getPosition();
+  // screen pixels covered by one world unit at a distance of one
+  const float pixelsPerUnit = std::abs(frameInfo.camera.getProjection()[1][1]) * .5f *
+                              static_cast<float>(frameInfo.extent.height);
+  // world space planes, objects outside the view would otherwise eat into the triangle budget
+  const LveClusterCullInfo frustum{frameInfo.camera, glm::mat4{1.f}, false};
+
+  uint64_t triangleCount = 0;
+  for (auto& kv : frameInfo.gameObjects) {
+    auto& obj = kv.second;
+    if (obj.model == nullptr) continue;
+
+    //model position in the world
+    //parent: combines parent world with childs local
+    //no parent: uses own transforms
+    DrawEntry entry{&obj, obj.getWorldMatrix(frameInfo.gameObjects), 0.f, 0};
+    glm::mat3 linear{entry.worldMatrix};
+    float maxScale = std::sqrt(std::max(
+        {glm::dot(linear[0], linear[0]),
+         glm::dot(linear[1], linear[1]),
+         glm::dot(linear[2], linear[2])}));
+    glm::vec3 center{entry.worldMatrix * glm::vec4{obj.model->getBoundsCenter(), 1.f}};
+    float radius = obj.model->getBoundsRadius() * maxScale;
+    if (!frustum.isSphereVisible(center, radius)) continue;
+    entry.distance = std::max(glm::length(center - cameraPosition) - radius, kMinLodDistance);
+
+    // coarsest lod whose error still projects below the threshold
+    const auto& lods = obj.model->getLods();
+    float errorScale = maxScale * pixelsPerUnit / entry.distance;
+    for (uint32_t lod = static_cast<uint32_t>(lods.size()) - 1; lod > 0; lod--) {
+      if (lods[lod].error * errorScale <= lodErrorThreshold) {
+        entry.lod = lod;
+        break;
+      }
+    }
+    triangleCount += lods[entry.lod].indexCount / 3;
+    drawEntries.push_back(entry);
+  }
+
+  if (triangleCount > triangleBudget) {
+    // over budget, coarsen the farthest objects first
+    drawOrder.resize(drawEntries.size());
+    std::iota(drawOrder.begin(), drawOrder.end(), 0u);
+    std::sort(drawOrder.begin(), drawOrder.end(), [this](uint32_t a, uint32_t b) {
+      return drawEntries[a].distance > drawEntries[b].distance;
+    });
+    for (uint32_t i : drawOrder) {
+      DrawEntry& entry = drawEntries[i];
+      const auto& lods = entry.object->model->getLods();
+      while (triangleCount > triangleBudget && entry.lod + 1 < lods.size()) {
+        triangleCount -= lods[entry.lod].indexCount / 3 - lods[entry.lod + 1].indexCount / 3;
+        entry.lod++;
+      }
+      if (triangleCount <= triangleBudget) break;
+    }
+  }
+  selectedTriangleCount = static_cast<uint32_t>(triangleCount);
+}
+
+uint32_t SimpleRenderSystem::getPipelineIndex(const LveGameObject& obj) const {
+  // only objects the pre-pass could draw are in the depth buffer already
+  uint32_t format = static_cast<uint32_t>(obj.model->getVertexFormat());
+  bool depthEqual = depthPrepass && obj.model->hasPositionStream();
+  return depthEqual ? LveModel::kVertexFormatCount + format : format;
 }
 
 void SimpleRenderSystem::renderGameObjects(FrameInfo& frameInfo) {
-  lvePipeline->bind(frameInfo.commandBuffer);
+  if (bindlessTextures != nullptr) {
+    bindlessTextures->beginFrame(frameInfo.frameIndex);
+  } else {
+    textureDescriptors->beginFrame(frameInfo.frameIndex);
+  }
 
+  // all pipelines share one layout, so the descriptor sets stay bound across pipeline switches
+  LvePipeline* boundPipeline = lvePipelines[0].get();
+  boundPipeline->bind(frameInfo.commandBuffer);
+
+  // the bindless array is bound once here, textures drawn for the first time are written into it
+  // afterwards
+  std::array<VkDescriptorSet, 2> frameSets{frameInfo.globalDescriptorSet};
+  if (bindlessTextures != nullptr) {
+    frameSets[1] = bindlessTextures->getDescriptorSet();
+  }
   vkCmdBindDescriptorSets(
       frameInfo.commandBuffer,
       VK_PIPELINE_BIND_POINT_GRAPHICS,
       pipelineLayout,
       0,
-      1,
-      &frameInfo.globalDescriptorSet,
+      bindlessTextures != nullptr ? 2 : 1,
+      frameSets.data(),
       0,
       nullptr);
 
-  for (auto& kv : frameInfo.gameObjects) {
-    auto& obj = kv.second;
-    if (obj.model == nullptr) continue;
-
-    // Bind texture descriptor if object has a texture
+  // grouped by pipeline, texture and model so state only changes between groups, front to back
+  // inside each group
+  renderQueue.clear();
+  textureIds.clear();
+  modelIds.clear();
+  for (uint32_t i = 0; i < drawEntries.size(); i++) {
+    const auto& obj = *drawEntries[i].object;
+    uint32_t textureId = 0;
     if (obj.texture != nullptr) {
-      //create descriptor pointing to this objects texture
-      VkDescriptorImageInfo imageInfo{};
-      imageInfo.sampler = obj.texture->getSampler();
-      imageInfo.imageView = obj.texture->getImageView();
-      imageInfo.imageLayout = obj.texture->getImageLayout();
-
-      VkDescriptorSet textureDescriptorSet;
-      LveDescriptorWriter(*textureSetLayout, frameInfo.frameDescriptorPool)
-          .writeImage(0, &imageInfo)
-          .build(textureDescriptorSet);
-
-      vkCmdBindDescriptorSets(
-          frameInfo.commandBuffer,
-          VK_PIPELINE_BIND_POINT_GRAPHICS,
-          pipelineLayout,
-          1,  // Set 1 is for texture
-          1,
-          &textureDescriptorSet,
-          0,
-          nullptr);
+      textureId = textureIds.emplace(obj.texture.get(), textureIds.size() + 1).first->second;
+    }
+    uint32_t modelId = modelIds.emplace(obj.model.get(), modelIds.size()).first->second;
+    renderQueue.submit(
+        LveRenderQueue::makeKey(
+            0, getPipelineIndex(obj), textureId, modelId, drawEntries[i].distance),
+        i);
+  }
+  renderQueue.sort();
+
+  // models share geometry blocks, so most of them find their buffers already bound
+  const LveModel* boundModel = nullptr;
+  VkDescriptorSet boundTextureSet = VK_NULL_HANDLE;
+  for (const auto& packet : renderQueue.getPackets()) {
+    const auto& entry = drawEntries[packet.item];
+    auto& obj = *entry.object;
+
+    uint32_t pipelineIndex = getPipelineIndex(obj);
+    LvePipeline* pipeline =
+        pipelineIndex >= LveModel::kVertexFormatCount
+            ? depthEqualPipelines[pipelineIndex - LveModel::kVertexFormatCount].get()
+            : lvePipelines[pipelineIndex].get();
+    if (pipeline != boundPipeline) {
+      pipeline->bind(frameInfo.commandBuffer);
+      boundPipeline = pipeline;
+    }
+
+    // Bind texture descriptor if object has a texture, objects sharing it are drawn in a row
+    if (obj.texture != nullptr && bindlessTextures == nullptr) {
+      //written the first time this texture is drawn
+      VkDescriptorSet textureDescriptorSet = textureDescriptors->getDescriptorSet(*obj.texture);
+      if (textureDescriptorSet != boundTextureSet) {
+        boundTextureSet = textureDescriptorSet;
+        vkCmdBindDescriptorSets(
+            frameInfo.commandBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            pipelineLayout,
+            1,  // Set 1 is for texture
+            1,
+            &textureDescriptorSet,
+            0,
+            nullptr);
+      }
     }
 
     SimplePushConstantData push{};
 
-    //model position in the world
-    //parent: combines parent world with childs local
-    //no parent: uses own transforms
-    push.modelMatrix = obj.getWorldMatrix(frameInfo.gameObjects);
+    const glm::mat4& worldMatrix = entry.worldMatrix;
+    //compact vertex formats store positions relative to the mesh bounds
+    push.modelMatrix = worldMatrix * obj.model->getDequantizationMatrix();
 
-    //rotation and scale only
-    glm::mat3 worldR= glm::mat3(push.modelMatrix);
+    //rotation and scale only, from the world matrix so the dequantization scale stays out of it
+    glm::mat3 worldR= glm::mat3(worldMatrix);
     push.normalMatrix = glm::transpose(glm::inverse(worldR));//
+    //the shaders only read the 3x3, the bindless fragment shader finds the texture index in the
+    //spare column. a float is exact for any index the array can hold
+    if (bindlessTextures != nullptr) {
+      push.normalMatrix[3][0] =
+          obj.texture != nullptr ? static_cast<float>(bindlessTextures->getIndex(*obj.texture))
+                                 : -1.f;
+    }
 
     vkCmdPushConstants(
         frameInfo.commandBuffer,
@@ -133,8 +280,12 @@ void SimpleRenderSystem::renderGameObjects(FrameInfo& frameInfo) {
         0,
         sizeof(SimplePushConstantData),
         &push);
-    obj.model->bind(frameInfo.commandBuffer);
-    obj.model->draw(frameInfo.commandBuffer);
+    obj.model->bind(frameInfo.commandBuffer, boundModel);
+    boundModel = obj.model.get();
+    obj.model->drawVisible(
+        frameInfo.commandBuffer,
+        LveClusterCullInfo{frameInfo.camera, worldMatrix, coneCulling},
+        entry.lod);
   }
 }
 
@@ -1,13 +1,19 @@
 #pragma once
 
+#include "lve/lve_bindless_textures.hpp"
 #include "lve/lve_camera.hpp"
 #include "lve/lve_device.hpp"
 #include "lve/lve_frame_info.hpp"
 #include "lve/lve_game_object.hpp"
+#include "lve/lve_model.hpp"
 #include "lve/lve_pipeline.hpp"
+#include "lve/lve_render_queue.hpp"
+#include "lve/lve_texture_descriptor_cache.hpp"
 
 // std
+#include <array>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace lve {
@@ -20,17 +26,73 @@ class SimpleRenderSystem {
   SimpleRenderSystem(const SimpleRenderSystem &) = delete;
   SimpleRenderSystem &operator=(const SimpleRenderSystem &) = delete;
 
+  /**
+   * Picks the lod of every object in view for this frame, objects outside the frustum get no
+   * draw entry. Call it before renderGameObjects and before any other pass that consumes
+   * getDrawEntries().
+   */
+  void selectLods(FrameInfo &frameInfo);
   void renderGameObjects(FrameInfo &frameInfo);
 
+  /**
+   * Bindless when the device supports it: every texture sits in one array bound once per frame
+   * and draws pass their texture index, so there is no descriptor set bind between draws.
+   * Otherwise each texture has its own set, bound per draw.
+   */
+  bool usesBindlessTextures() const { return bindlessTextures != nullptr; }
+
+  /**
+   * When enabled, objects with a position stream are assumed to be in the depth buffer already
+   * (see DepthPrepassSystem) and are shaded with an EQUAL depth test and no depth writes.
+   */
+  void setDepthPrepass(bool enabled) { depthPrepass = enabled; }
+
+  // largest simplification error a lod may show on screen, in pixels
+  void setLodErrorThreshold(float pixels) { lodErrorThreshold = pixels; }
+  // upper bound for the triangles of all selected lods, the farthest objects give way first
+  void setTriangleBudget(uint32_t triangles) { triangleBudget = triangles; }
+  uint32_t getSelectedTriangleCount() const { return selectedTriangleCount; }
+
+  struct DrawEntry {
+    LveGameObject *object;
+    glm::mat4 worldMatrix;
+    float distance;  // from the camera to the bounding sphere
+    uint32_t lod;
+  };
+  const std::vector<DrawEntry> &getDrawEntries() const { return drawEntries; }
+
  private:
   void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
   void createPipeline(VkRenderPass renderPass);
+  // lvePipelines by vertex format, then depthEqualPipelines, also the pipeline field of sort keys
+  uint32_t getPipelineIndex(const LveGameObject &obj) const;
 
   LveDevice &lveDevice;
 
-  std::unique_ptr<LvePipeline> lvePipeline;
+  // one pipeline per LveModel::VertexFormat, they share the layout and the fragment shader
+  std::array<std::unique_ptr<LvePipeline>, LveModel::kVertexFormatCount> lvePipelines;
+  // the same with an EQUAL depth test, for objects the depth pre-pass already drew
+  std::array<std::unique_ptr<LvePipeline>, LveModel::kVertexFormatCount> depthEqualPipelines;
+  bool depthPrepass = false;
   VkPipelineLayout pipelineLayout;
+  // meshlet normal cones can only be culled when the pipelines drop back faces anyway
+  bool coneCulling = false;
+
+  float lodErrorThreshold = 1.f;
+  uint32_t triangleBudget = 2'000'000;
+  uint32_t selectedTriangleCount = 0;
+  std::vector<DrawEntry> drawEntries;
+  std::vector<uint32_t> drawOrder;
+  // drawEntries in draw order: pipeline, texture, model, then front to back
+  LveRenderQueue renderQueue;
+  // dense per frame ids for the sort key, 0 is no texture
+  std::unordered_map<const Texture *, uint32_t> textureIds;
+  std::unordered_map<const LveModel *, uint32_t> modelIds;
 
-  std::unique_ptr<LveDescriptorSetLayout> textureSetLayout; // Layout for textures
+  std::shared_ptr<LveDescriptorSetLayout> textureSetLayout; // Layout for textures, shared
+  // written once per texture, the draw loop only binds
+  std::unique_ptr<LveTextureDescriptorCache> textureDescriptors;
+  // replaces the two above when the device supports it
+  std::unique_ptr<LveBindlessTextures> bindlessTextures;
 };
 }  // namespace lve